@@ -5,6 +5,9 @@
 #define _USE_MATH_DEFINES
 
 #define DEBUG_MODE
+//#define HEADLESS_MODE
+//#define MICROBENCH_MODE
+//#define TEST_MODE
 
 #define GLM_FORCE_RADIANS
 
@@ -18,11 +21,49 @@
 #include <map>
 #include <vector>
 #include <list>
+#include <algorithm>
+#include <functional>
+#include <atomic>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+#include <cassert>
 
 #include <math.h>
+#include <malloc.h>
 
+#ifndef _MSC_VER
+// POSIX stand-ins for the MSVC aligned allocation functions.
+inline void* _aligned_malloc( size_t size, size_t alignment )
+{
+	void* p = nullptr;
+	return posix_memalign( &p, alignment, size ) ? nullptr : p;
+}
+
+inline void _aligned_free( void* p )
+{
+	free( p );
+}
+#endif
+
+#ifdef WINDOWLESS
+// Set by CMakeLists.txt, whose windowless targets link only sources making no
+// GL calls and opening no window. They need just the GL 1.1 types and enums
+// the terrain sources use, and neither GLEW nor GLFW.
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+#include <GL/gl.h>
+#else
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#endif
 
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
@@ -0,0 +1,361 @@
+#include "Base.h"
+#include "BlockStorage.h"
+
+
+/*!
+ * Creates storage for count blocks, all initially air. No array is
+ * allocated until a block other than air is written.
+ */
+FlatStorage::FlatStorage( int count ) :
+	blocks( nullptr ),
+	count( count )
+{
+	uniform.id = 0;
+}
+
+
+FlatStorage::~FlatStorage( void )
+{
+	_aligned_free( blocks );
+}
+
+
+/*!
+ * Allocates the block array, filled with the uniform id.
+ */
+void FlatStorage::materialise( void )
+{
+	size_t bytes = ( sizeof ( Block ) * count + TRN_BLOCK_ALIGN - 1 ) & ~(size_t) ( TRN_BLOCK_ALIGN - 1 );
+
+	blocks = (Block*) _aligned_malloc( bytes, TRN_BLOCK_ALIGN );
+	memset( blocks, uniform.id, bytes );
+}
+
+
+/*!
+ * Replaces every block from the given array, in storage order. The result is
+ * already compact.
+ */
+void FlatStorage::load( const Block* in )
+{
+	int i;
+	for ( i = 1; i < count; i++ )
+		if ( in[i].id != in[0].id )
+			break;
+
+	if ( i == count )
+	{
+		_aligned_free( blocks );
+		blocks  = nullptr;
+		uniform = in[0];
+		return;
+	}
+
+	if ( !blocks )
+		materialise();
+
+	memcpy( blocks, in, sizeof ( Block ) * count );
+}
+
+
+/*!
+ * Copies every block, in storage order, to the given array.
+ */
+void FlatStorage::unpack( Block* out ) const
+{
+	if ( blocks )
+		memcpy( out, blocks, sizeof ( Block ) * count );
+	else
+		memset( out, uniform.id, sizeof ( Block ) * count );
+}
+
+
+/*!
+ * Frees the block array if every block holds the same id.
+ */
+void FlatStorage::compact( void )
+{
+	if ( !blocks )
+		return;
+
+	for ( int i = 1; i < count; i++ )
+		if ( blocks[i].id != blocks[0].id )
+			return;
+
+	uniform = blocks[0];
+
+	_aligned_free( blocks );
+	blocks = nullptr;
+}
+
+
+/*!
+ * Returns true if every block holds the same id and no array is allocated.
+ */
+bool FlatStorage::isUniform( void ) const
+{
+	return !blocks;
+}
+
+
+/*!
+ * Returns the number of bytes allocated for the blocks.
+ */
+size_t FlatStorage::getMemoryUsage( void ) const
+{
+	if ( !blocks )
+		return 0;
+
+	return ( sizeof ( Block ) * count + TRN_BLOCK_ALIGN - 1 ) & ~(size_t) ( TRN_BLOCK_ALIGN - 1 );
+}
+
+
+/*!
+ * Creates storage for count blocks, all initially air. Indices start at 0
+ * bits, so nothing is allocated until a block other than air is written.
+ */
+PaletteStorage::PaletteStorage( int count ) :
+	palette( 1, 0 ),
+	words( nullptr ),
+	count( count ),
+	bits( 0 ),
+	shift( 5 )
+{
+}
+
+
+PaletteStorage::~PaletteStorage( void )
+{
+	delete[] words;
+}
+
+
+/*!
+ * Returns the palette index of a block id, adding it to the palette and
+ * widening the indices if it is not already present.
+ */
+int PaletteStorage::findOrAdd( char id )
+{
+	for ( int p = 0; p < (int) palette.size(); p++ )
+		if ( palette[p] == id )
+			return p;
+
+	palette.push_back( id );
+	if ( (int) palette.size() > ( 1 << bits ) )
+		grow();
+
+	return (int) palette.size() - 1;
+}
+
+
+/*!
+ * Doubles the width of every index, repacking the words. Growing from 0
+ * bits allocates the words, all pointing at the first palette entry.
+ */
+void PaletteStorage::grow( void )
+{
+	int newBits  = bits ? bits * 2 : 1;
+	int newShift = bits ? shift - 1 : 5;
+	int n = ( count + ( 1 << newShift ) - 1 ) >> newShift;
+
+	unsigned int* newWords = new unsigned int[n];
+	memset( newWords, 0, sizeof ( unsigned int ) * n );
+
+	if ( words )
+	{
+		unsigned int mask = ( 1u << bits ) - 1;
+		for ( int i = 0; i < count; i++ )
+		{
+			unsigned int p = ( words[i >> shift] >> ( ( i & ( ( 1 << shift ) - 1 ) ) * bits ) ) & mask;
+			newWords[i >> newShift] |= p << ( ( i & ( ( 1 << newShift ) - 1 ) ) * newBits );
+		}
+	}
+
+	delete[] words;
+	words = newWords;
+	bits  = newBits;
+	shift = newShift;
+}
+
+
+/*!
+ * Sets the block at offset i.
+ */
+void PaletteStorage::set( int i, Block b )
+{
+	unsigned int p = (unsigned int) findOrAdd( b.id );
+
+	// Still uniform, and the id matches.
+	if ( !words )
+		return;
+
+	unsigned int slot = ( i & ( ( 1 << shift ) - 1 ) ) * bits;
+	unsigned int& word = words[i >> shift];
+
+	word = ( word & ~( ( ( 1u << bits ) - 1 ) << slot ) ) | ( p << slot );
+}
+
+
+/*!
+ * Replaces every block from the given array, in storage order, building the
+ * palette and packing the indices at the narrowest width in one go. The
+ * result is already compact.
+ */
+void PaletteStorage::load( const Block* in )
+{
+	int index[256];
+	memset( index, -1, sizeof ( index ) );
+
+	palette.clear();
+	for ( int i = 0; i < count; i++ )
+	{
+		unsigned char id = (unsigned char) in[i].id;
+		if ( index[id] < 0 )
+		{
+			index[id] = (int) palette.size();
+			palette.push_back( in[i].id );
+		}
+	}
+
+	delete[] words;
+	words = nullptr;
+	bits  = 0;
+	shift = 5;
+
+	if ( palette.size() == 1 )
+		return;
+
+	bits = 1;
+	while ( (int) palette.size() > ( 1 << bits ) )
+	{
+		bits *= 2;
+		shift--;
+	}
+
+	int n = ( count + ( 1 << shift ) - 1 ) >> shift;
+	words = new unsigned int[n];
+	memset( words, 0, sizeof ( unsigned int ) * n );
+
+	for ( int i = 0; i < count; i++ )
+		words[i >> shift] |= (unsigned int) index[(unsigned char) in[i].id] << ( ( i & ( ( 1 << shift ) - 1 ) ) * bits );
+}
+
+
+/*!
+ * Decodes every block, in storage order, to the given array. This is much
+ * faster than calling get() per block, so bulk readers such as the mesher
+ * should use it.
+ */
+void PaletteStorage::unpack( Block* out ) const
+{
+	if ( !words )
+	{
+		memset( out, palette[0], sizeof ( Block ) * count );
+		return;
+	}
+
+	unsigned int mask = ( 1u << bits ) - 1;
+	int perWord = 1 << shift;
+
+	for ( int w = 0, i = 0; i < count; w++ )
+	{
+		unsigned int word = words[w];
+		for ( int s = 0; s < perWord && i < count; s++, i++ )
+		{
+			out[i].id = palette[word & mask];
+			word >>= bits;
+		}
+	}
+}
+
+
+/*!
+ * Drops palette entries no longer referenced by any block and narrows the
+ * indices to fit. If only one id remains the words are freed entirely.
+ */
+void PaletteStorage::compact( void )
+{
+	if ( !words )
+		return;
+
+	// Decode indices and count how often each is used.
+	std::vector<unsigned char> indices( count );
+	int used[256] = { 0 };
+	unsigned int mask = ( 1u << bits ) - 1;
+	for ( int i = 0; i < count; i++ )
+	{
+		indices[i] = (unsigned char) ( ( words[i >> shift] >> ( ( i & ( ( 1 << shift ) - 1 ) ) * bits ) ) & mask );
+		used[indices[i]]++;
+	}
+
+	// Build the reduced palette and a remapping from old indices.
+	std::vector<char> reduced;
+	unsigned char remap[256];
+	for ( int p = 0; p < (int) palette.size(); p++ )
+	{
+		if ( used[p] )
+		{
+			remap[p] = (unsigned char) reduced.size();
+			reduced.push_back( palette[p] );
+		}
+	}
+
+	if ( reduced.size() == palette.size() )
+		return;
+
+	palette = reduced;
+	delete[] words;
+	words = nullptr;
+	bits  = 0;
+	shift = 5;
+
+	if ( palette.size() == 1 )
+		return;
+
+	// Narrowest width that fits the reduced palette, then repack.
+	bits = 1;
+	while ( (int) palette.size() > ( 1 << bits ) )
+	{
+		bits *= 2;
+		shift--;
+	}
+
+	int n = ( count + ( 1 << shift ) - 1 ) >> shift;
+	words = new unsigned int[n];
+	memset( words, 0, sizeof ( unsigned int ) * n );
+
+	for ( int i = 0; i < count; i++ )
+		words[i >> shift] |= (unsigned int) remap[indices[i]] << ( ( i & ( ( 1 << shift ) - 1 ) ) * bits );
+}
+
+
+/*!
+ * Returns true if every block holds the same id and no words are allocated.
+ */
+bool PaletteStorage::isUniform( void ) const
+{
+	return !words;
+}
+
+
+/*!
+ * Returns the width of each palette index in bits.
+ */
+int PaletteStorage::getBits( void ) const
+{
+	return bits;
+}
+
+
+/*!
+ * Returns the number of bytes allocated for the indices and palette.
+ */
+size_t PaletteStorage::getMemoryUsage( void ) const
+{
+	if ( !words )
+		return palette.capacity();
+
+	int n = ( count + ( 1 << shift ) - 1 ) >> shift;
+
+	return sizeof ( unsigned int ) * n + palette.capacity();
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+
+#include "MacroTerrain.h"
+
+
+struct Block {
+	char id;
+};
+
+
+/*!
+ * Plain voxel storage: one aligned Block per voxel. While every block holds
+ * the same id no array is allocated; it is materialised on the first write of
+ * a different id.
+ */
+class FlatStorage {
+private:
+	Block* blocks;
+	Block  uniform;
+	int count;
+
+	void materialise( void );
+
+public:
+	FlatStorage( int count );
+	~FlatStorage( void );
+
+	// Owns a raw heap buffer, so copies would free it twice.
+	FlatStorage( const FlatStorage& ) = delete;
+	FlatStorage& operator=( const FlatStorage& ) = delete;
+
+	Block get( int i ) const;
+	void  set( int i, Block b );
+
+	void load( const Block* in );
+	void unpack( Block* out ) const;
+	void compact( void );
+
+	bool   isUniform( void ) const;
+	size_t getMemoryUsage( void ) const;
+};
+
+
+/*!
+ * Palette-compressed voxel storage. Each voxel holds an index into a small
+ * per-chunk palette of block ids, bit-packed into 32 bit words. Indices double
+ * in width (1, 2, 4, 8) as new ids are added, so no index ever straddles a
+ * word. A single-id palette needs 0 bits, so uniform chunks have no words.
+ */
+class PaletteStorage {
+private:
+	std::vector<char> palette;
+	unsigned int* words;
+	int count;
+	int bits;
+	int shift;
+
+	int  findOrAdd( char id );
+	void grow( void );
+
+public:
+	PaletteStorage( int count );
+	~PaletteStorage( void );
+
+	// Owns a raw heap buffer, so copies would free it twice.
+	PaletteStorage( const PaletteStorage& ) = delete;
+	PaletteStorage& operator=( const PaletteStorage& ) = delete;
+
+	Block get( int i ) const;
+	void  set( int i, Block b );
+
+	void load( const Block* in );
+	void unpack( Block* out ) const;
+	void compact( void );
+
+	bool   isUniform( void ) const;
+	int    getBits( void ) const;
+	size_t getMemoryUsage( void ) const;
+};
+
+
+#ifdef TRN_PALETTE
+typedef PaletteStorage BlockStorage;
+#else
+typedef FlatStorage BlockStorage;
+#endif
+
+
+/*!
+ * Returns the block at offset i.
+ */
+inline Block FlatStorage::get( int i ) const
+{
+	return blocks ? blocks[i] : uniform;
+}
+
+
+/*!
+ * Sets the block at offset i.
+ */
+inline void FlatStorage::set( int i, Block b )
+{
+	if ( !blocks )
+	{
+		if ( b.id == uniform.id )
+			return;
+
+		materialise();
+	}
+
+	blocks[i] = b;
+}
+
+
+/*!
+ * Returns the block at offset i, decoded through the palette.
+ */
+inline Block PaletteStorage::get( int i ) const
+{
+	if ( !words )
+	{
+		Block b = { palette[0] };
+		return b;
+	}
+
+	unsigned int word = words[i >> shift];
+	unsigned int slot = ( i & ( ( 1 << shift ) - 1 ) ) * bits;
+	Block b;
+	b.id = palette[( word >> slot ) & ( ( 1u << bits ) - 1 )];
+
+	return b;
+}
@@ -1,57 +1,132 @@
 #include "Base.h"
 #include "Chunk.h"
 
-#include "Mesh.h"
+#include "ChunkSnapshot.h"
+#include "Mesher.h"
+#include "MesherWorkspace.h"
 #include "Terrain.h"
+#include "TerrainMesh.h"
 
 
+std::atomic<int> Chunk::nextID( 0 );
+
+
+/*!
+ * Creates a chunk of air. See GenPipeline for filling it with terrain.
+ */
 Chunk::Chunk( glm::ivec3 position, int size, Terrain* terrain ) :
+	blocks( size * size * size ),
 	terrain( terrain ),
+	mesh( nullptr ),
 	changed( true ),
 	position( position ),
 	positionAbs( position * size ),
 	size( size ),
-	id( (int)( glfwGetTime() * 100000 ) )
+	id( nextID++ )
 {
-	blocks = new Block**[size];
-	for ( int i = 0; i < size; i++ )
-	{
-		blocks[i] = new Block*[size];
-		for ( int j = 0; j < size; j++ )
-		{
-			blocks[i][j] = new Block[size];
-			for ( int k = 0; k < size; k++ )
-			{
-				int x = i + position.x * size;
-				int y = j + position.y * size;
-				int z = k + position.z * size;
-
-				float slope = 48 - sqrtf( powf( 1 - x / 144.0f, 4 ) + powf( 1 - z / 144.0f, 4 ) ) * 80;
-				if ( y < slope + ( glm::simplex( glm::vec2( x / 100.0, z / 100.0 ) ) + 1 ) * 16 )
-				{
-					blocks[i][j][k].id = 3;
-				} else
-				{
-					blocks[i][j][k].id = 0;
-				}
-			}
-		}
-	}
+#ifdef TRN_MORTON
+	if ( size & ( size - 1 ) || size > 32 )
+		throw std::runtime_error( "Morton chunk storage requires a power-of-two size up to 32." );
+#endif
+
+	if ( size > 63 )
+		throw std::runtime_error( "Packed terrain vertices hold chunks of up to 63 blocks." );
+}
+
+
+/*!
+ * Shrinks the voxel storage to fit its contents, dropping it entirely if
+ * every block holds the same id. Call after bulk edits such as generation.
+ */
+void Chunk::compact( void )
+{
+	blocks.compact();
+}
+
+
+/*!
+ * Returns true if every block in the chunk holds the same id.
+ */
+bool Chunk::isUniform( void ) const
+{
+	return blocks.isUniform();
+}
+
+
+/*!
+ * Replaces every block from the given size^3 array, ordered linearly as
+ * [x][y][z] whatever the storage index order. The storage is left compact.
+ */
+void Chunk::load( const Block* in )
+{
+#ifdef TRN_MORTON
+	std::vector<Block> stored( size * size * size );
+	for ( int x = 0; x < size; x++ )
+	for ( int y = 0; y < size; y++ )
+	for ( int z = 0; z < size; z++ )
+		stored[index( x, y, z )] = *in++;
+
+	blocks.load( &stored[0] );
+#else
+	blocks.load( in );
+#endif
+
+	changed = true;
+}
+
+
+/*!
+ * Decodes every block into the given size^3 array, ordered linearly as
+ * [x][y][z] whatever the storage index order.
+ */
+void Chunk::unpack( Block* out ) const
+{
+#ifdef TRN_MORTON
+	std::vector<Block> stored( size * size * size );
+	blocks.unpack( &stored[0] );
+
+	for ( int x = 0; x < size; x++ )
+	for ( int y = 0; y < size; y++ )
+	for ( int z = 0; z < size; z++ )
+		*out++ = stored[index( x, y, z )];
+#else
+	blocks.unpack( out );
+#endif
 }
 
 
 /*!
- * Returns the block type at this position in the chunk.
+ * Returns a 64 bit FNV-1a hash of the chunk's blocks, taken in [x][y][z]
+ * order so that it does not depend on the storage or index order.
  */
-Block& Chunk::getBlockAt( glm::ivec3 pos )
+unsigned long long Chunk::getHash( void ) const
 {
-	return blocks[pos.x][pos.y][pos.z];
+	std::vector<Block> linear( size * size * size );
+	unpack( &linear[0] );
+
+	unsigned long long hash = 14695981039346656037ULL;
+	for ( auto& b : linear )
+		hash = ( hash ^ (unsigned char) b.id ) * 1099511628211ULL;
+
+	return hash;
 }
 
 
-Block& Chunk::getBlockAt( int x, int y, int z )
+/*!
+ * Returns the position of the chunk in chunk coordinates.
+ */
+glm::ivec3 Chunk::getPosition( void ) const
 {
-	return blocks[x][y][z];
+	return position;
+}
+
+
+/*!
+ * Returns the voxel storage, for bulk readers and memory statistics.
+ */
+const BlockStorage& Chunk::getStorage( void ) const
+{
+	return blocks;
 }
 
 
@@ -65,130 +140,113 @@ int Chunk::getID( void )
 
 
 /*!
- * Returns a pointer to the mesh for this chunk.
+ * Builds the chunk's geometry with the selected greedy mesher, returning
+ * false if it has no visible faces. Touches no GL, and only reads blocks, so
+ * any number of chunks may be built at once on other threads as long as
+ * nothing edits the terrain meanwhile. Scratch memory comes from the calling
+ * thread's MesherWorkspace, so a reused out allocates nothing once warm.
  */
-Mesh* Chunk::getMesh()
+bool Chunk::buildMesh( MeshData* out ) const
 {
-	if ( changed )
-	{
-		changed = false;
-		mesh = generateMesh();
-	}
+	out->vertices.clear();
+	out->indices.clear();
+#ifdef TRN_QUAD_INDICES
+	out->mode   = GL_TRIANGLES;
+#else
+	out->mode   = GL_TRIANGLE_FAN;
+#endif
+	out->offset = positionAbs;
+	out->min    = out->max = glm::ivec3( 0 );
+	out->solid  = 0;
+
+	// All-air chunks have no faces of their own.
+	if ( blocks.isUniform() && blocks.get( 0 ).id == 0 )
+		return false;
+
+	// Copy the chunk and its border once, so the mesher reads plain bytes
+	// and never goes through Terrain.
+	MesherWorkspace* workspace = MesherWorkspace::local();
+	workspace->prepare( size );
+	workspace->snapshot.capture( this, terrain );
+
+	// Reserve for the largest mesh this thread has built, so reused output
+	// never regrows.
+	out->vertices.reserve( workspace->vertexHint );
+	out->indices.reserve( workspace->indexHint );
+
+	Mesher::generate( workspace->snapshot, terrain->getBlockTypes(), &out->vertices, &out->indices );
+	TerrainMesh::findBounds( out );
+	out->solid = Mesher::findSolidFaces( workspace->snapshot );
+
+	workspace->vertexHint = std::max( workspace->vertexHint, out->vertices.size() );
+	workspace->indexHint  = std::max( workspace->indexHint, out->indices.size() );
+
+	return !out->vertices.empty();
+}
 
-	return mesh;
+
+/*!
+ * Returns true if the blocks have changed since the mesh was last set.
+ */
+bool Chunk::isChanged( void ) const
+{
+	return changed;
 }
 
 
 /*!
- * Generates a mesh for the chunk using a greedy alogrithm.
+ * Marks the chunk for remeshing, as when a neighbour's border blocks change.
  */
-Mesh* Chunk::generateMesh()
+void Chunk::markChanged( void )
 {
-	std::vector<vertex> vertices;
-	std::vector<GLuint> indices;
-	
+	changed = true;
+}
+
+
+/*!
+ * Marks the chunk for remeshing after the block at this position changed.
+ * Meshes read one layer into each face neighbour, so a block on the border
+ * also marks the neighbour on that side.
+ */
+void Chunk::touch( int x, int y, int z )
+{
+	changed = true;
+
+	if ( !terrain )
+		return;
+
+	glm::ivec3 pos( x, y, z );
 	for ( int d = 0; d < 3; d++ )
 	{
-		glm::ivec3 p, q;
-		int u = ( d == 0 ) ? 2 : 0;
-		int v = ( d == 1 ) ? 2 : 1;
-		char** type = new char*[size];
-		bool** face = new bool*[size];
-		for ( int m = 0; m < size; m++ )
-		{
-			type[m] = new char[size];
-			face[m] = new bool[size];
-		}
-
-		q[d] = 1;
-
-		// Perform algorithm on set of 2D slices along axis d.
-		for ( p[d] = 0; p[d] <= size; p[d]++ )
-		{
-			// Compute mask for slice.
-			for ( p[u] = 0; p[u] < size; p[u]++ )
-			for ( p[v] = 0; p[v] < size; p[v]++ )
-			{
-				char near = (
-					p[d] == 0 ?
-					terrain->getBlockAt( p - q + positionAbs ).id :
-					blocks[p[0]-q[0]][p[1]-q[1]][p[2]-q[2]].id
-				);
-				char far = (
-					p[d] == size ?
-					terrain->getBlockAt( p + positionAbs ).id :
-					blocks[p[0]][p[1]][p[2]].id
-				);
-				type[p[u]][p[v]] = ( near != 0 ) ^ ( far != 0 ) ? near | far : 0;
-				face[p[u]][p[v]] = ( near != 0 );
-			}
-
-			// Generate mesh for slice lexicographically.
-			for ( int j = 0; j < size; j++ )
-			for ( int i = 0; i < size; )
-			{
-				char t = type[i][j];
-				if ( t > 0 )
-				{
-					// Whether the quad faces backwards along the axis.
-					bool f = face[i][j];
-
-					// Compute width and height of quad.
-					int w, h = size;
-					for ( w = 0; i + w < size && type[i+w][j] == t && face[i+w][j] == f; w++ )
-					{
-						int th;
-						for ( th = 1; j + th < size && type[i+w][j+th] == t && face[i+w][j+th] == f; th++ );
-						if ( h > th )
-							h = th;
-					}
-
-					// Flip faces on x and y axes because reasons.
-					if ( d != 2 )
-						f = !f;
-
-					// Add quad.
-					p[u] = f ? i : i + w;
-					p[v] = j;
-					glm::vec3 wd; wd[u] = (float) ( f ? w : -w );
-					glm::vec3 hd; hd[v] = (float) ( h );
-					int texture = terrain->getBlockTypeFromId(t).textures[d + (int) f];
-					std::cout << texture << std::endl;
-					Mesh::appendQuad(
-						quad(
-							glm::vec3( positionAbs ) + glm::vec3( p ),
-							glm::vec3( positionAbs ) + glm::vec3( p[0]+wd[0]      , p[1]+wd[1]      , p[2]+wd[2]       ),
-							glm::vec3( positionAbs ) + glm::vec3( p[0]+wd[0]+hd[0], p[1]+wd[1]+hd[1], p[2]+wd[2]+hd[2] ),
-							glm::vec3( positionAbs ) + glm::vec3( p[0]      +hd[0], p[1]      +hd[1], p[2]      +hd[2] ),
-							glm::vec3( f ? q : -q ),
-							(float) w, (float) h, texture
-						),
-						&vertices,
-						&indices
-					);
-
-					// Mark this area clear on mask.
-					for ( int l = i; l < i + w; l++ )
-					for ( int k = j; k < j + h; k++ )
-						type[l][k] = 0;
-
-					// Advance along by width of quad.
-					i += w;
-				} else
-					// Advance along by one.
-					i++;
-			}
-		}
-
-		// Deallocate mask.
-		for ( int m = 0; m < size; m++ )
-		{
-			delete[] type[m];
-			delete[] face[m];
-		}
-		delete[] type;
-		delete[] face;
+		if ( pos[d] != 0 && pos[d] != size - 1 )
+			continue;
+
+		glm::ivec3 offset( 0 );
+		offset[d] = pos[d] ? 1 : -1;
+
+		Chunk* n = terrain->getChunkAt( position + offset );
+		if ( n )
+			n->markChanged();
 	}
+}
+
 
-	return new Mesh( vertices, indices, GL_TRIANGLE_FAN );
+/*!
+ * Returns the uploaded mesh for this chunk, or null if it has none. See
+ * Renderer::uploadTerrain.
+ */
+TerrainMesh* Chunk::getMesh( void )
+{
+	return mesh;
+}
+
+
+/*!
+ * Sets the uploaded mesh for the chunk's current blocks, which may be null if
+ * it has no visible faces.
+ */
+void Chunk::setMesh( TerrainMesh* mesh )
+{
+	this->mesh = mesh;
+	changed = false;
 }
@@ -1,25 +1,25 @@
 #pragma once
 
 
-struct BlockType;
+#include "MacroTerrain.h"
+#include "BlockStorage.h"
 
-class Mesh;
-class Terrain;
 
+struct BlockType;
+struct MeshData;
 
-struct Block {
-	char id;
-};
+class Terrain;
+class TerrainMesh;
 
 
 class Chunk {
 private:
-	Block*** blocks;
+	// Voxel storage, size^3 blocks in the order given by index().
+	BlockStorage blocks;
 
 	Terrain* terrain;
 
-	Mesh* mesh;
-	Mesh* generateMesh();
+	TerrainMesh* mesh;
 	bool changed;
 
 	glm::ivec3 position;
@@ -27,12 +27,100 @@ private:
 	int size;
 	int id;
 
+	// Chunks are created on many threads at once, so ids come from a counter.
+	static std::atomic<int> nextID;
+
+	int  index( int x, int y, int z ) const;
+	void touch( int x, int y, int z );
+
 public:
 	Chunk( glm::ivec3 position, int size, Terrain* terrain );
-	
-	Block& getBlockAt( glm::ivec3 pos );
-	Block& getBlockAt( int x, int y, int z );
 
-	int   getID( void );
-	Mesh* getMesh();
+	Block getBlockAt( glm::ivec3 pos ) const;
+	Block getBlockAt( int x, int y, int z ) const;
+	void  setBlockAt( glm::ivec3 pos, Block b );
+	void  setBlockAt( int x, int y, int z, Block b );
+
+	void compact( void );
+	bool isUniform( void ) const;
+	void load( const Block* in );
+	void unpack( Block* out ) const;
+
+	unsigned long long getHash( void ) const;
+
+	glm::ivec3 getPosition( void ) const;
+
+	int  getID( void );
+	bool buildMesh( MeshData* out ) const;
+	bool isChanged( void ) const;
+	void markChanged( void );
+
+	TerrainMesh* getMesh( void );
+	void         setMesh( TerrainMesh* mesh );
+
+	const BlockStorage& getStorage( void ) const;
 };
+
+
+/*!
+ * Spreads the low five bits of a coordinate so that two zero bits lie
+ * between each, ready to be interleaved into a Morton code.
+ */
+inline unsigned int spreadBits( unsigned int v )
+{
+	v = ( v | ( v << 8 ) ) & 0x0000F00F;
+	v = ( v | ( v << 4 ) ) & 0x000C30C3;
+	v = ( v | ( v << 2 ) ) & 0x00249249;
+
+	return v;
+}
+
+
+/*!
+ * Returns the offset of a block into the storage array. See TRN_MORTON.
+ */
+inline int Chunk::index( int x, int y, int z ) const
+{
+#ifdef TRN_MORTON
+	return (int) ( ( spreadBits( x ) << 2 ) | ( spreadBits( y ) << 1 ) | spreadBits( z ) );
+#else
+	return ( x * size + y ) * size + z;
+#endif
+}
+
+
+/*!
+ * Returns the block type at this position in the chunk.
+ */
+inline Block Chunk::getBlockAt( glm::ivec3 pos ) const
+{
+	return blocks.get( index( pos.x, pos.y, pos.z ) );
+}
+
+
+inline Block Chunk::getBlockAt( int x, int y, int z ) const
+{
+	return blocks.get( index( x, y, z ) );
+}
+
+
+/*!
+ * Sets the block type at this position in the chunk. If that changes the
+ * block, this chunk and any face neighbours touching it are marked for
+ * remeshing.
+ */
+inline void Chunk::setBlockAt( glm::ivec3 pos, Block b )
+{
+	setBlockAt( pos.x, pos.y, pos.z, b );
+}
+
+
+inline void Chunk::setBlockAt( int x, int y, int z, Block b )
+{
+	int i = index( x, y, z );
+	if ( blocks.get( i ).id == b.id )
+		return;
+
+	blocks.set( i, b );
+	touch( x, y, z );
+}
@@ -0,0 +1,194 @@
+#include "Base.h"
+#include "ChunkMap.h"
+
+
+/*!
+ * Creates an empty map. The capacity is rounded up to a power of two.
+ */
+ChunkMap::ChunkMap( int capacity ) :
+	count( 0 )
+{
+	int c = 16;
+	while ( c < capacity )
+		c *= 2;
+
+	Slot empty = { 0, glm::ivec3( 0 ), nullptr };
+	slots.assign( c, empty );
+	mask = c - 1;
+}
+
+
+/*!
+ * Moves every entry into a fresh table of the given power-of-two capacity.
+ */
+void ChunkMap::rehash( int capacity )
+{
+	std::vector<Slot> old;
+	old.swap( slots );
+
+	Slot empty = { 0, glm::ivec3( 0 ), nullptr };
+	slots.assign( capacity, empty );
+	mask = capacity - 1;
+
+	for ( auto& s : old )
+	{
+		if ( !s.chunk )
+			continue;
+
+		unsigned int i = hash( s.key ) & mask;
+		while ( slots[i].chunk )
+			i = ( i + 1 ) & mask;
+		slots[i] = s;
+	}
+}
+
+
+/*!
+ * Inserts or replaces the chunk at the given chunk coordinates. The table
+ * grows to keep the load factor at or below one half.
+ */
+void ChunkMap::insert( glm::ivec3 pos, Chunk* chunk )
+{
+	if ( !chunk )
+	{
+		remove( pos );
+		return;
+	}
+
+	if ( ( count + 1 ) * 2 > (int) slots.size() )
+		rehash( (int) slots.size() * 2 );
+
+	unsigned long long key = pack( pos );
+	unsigned int i = hash( key ) & mask;
+	while ( slots[i].chunk )
+	{
+		if ( slots[i].key == key )
+		{
+			slots[i].chunk = chunk;
+			return;
+		}
+
+		i = ( i + 1 ) & mask;
+	}
+
+	Slot s = { key, pos, chunk };
+	slots[i] = s;
+	count++;
+}
+
+
+/*!
+ * Removes the entry at the given chunk coordinates, returning false if there
+ * was none. The chunk itself is not deleted.
+ */
+bool ChunkMap::remove( glm::ivec3 pos )
+{
+	unsigned long long key = pack( pos );
+	unsigned int i = hash( key ) & mask;
+	while ( slots[i].key != key || !slots[i].chunk )
+	{
+		if ( !slots[i].chunk )
+			return false;
+
+		i = ( i + 1 ) & mask;
+	}
+
+	// Shift later entries of the probe run back into the hole, so that no
+	// entry ends up separated from its home slot by an empty one.
+	for ( unsigned int j = ( i + 1 ) & mask; slots[j].chunk; j = ( j + 1 ) & mask )
+	{
+		unsigned int home = hash( slots[j].key ) & mask;
+		if ( ( ( j - home ) & mask ) >= ( ( j - i ) & mask ) )
+		{
+			slots[i] = slots[j];
+			i = j;
+		}
+	}
+
+	slots[i].chunk = nullptr;
+	count--;
+
+	return true;
+}
+
+
+/*!
+ * Removes every entry. Chunks are not deleted.
+ */
+void ChunkMap::clear( void )
+{
+	for ( auto& s : slots )
+		s.chunk = nullptr;
+
+	count = 0;
+}
+
+
+/*!
+ * Returns the number of chunks in the map.
+ */
+int ChunkMap::size( void ) const
+{
+	return count;
+}
+
+
+/*!
+ * Returns an iterator to the first occupied slot. Iteration order is
+ * unspecified.
+ */
+ChunkMap::const_iterator ChunkMap::begin( void ) const
+{
+	return const_iterator( slots.data(), slots.data() + slots.size() );
+}
+
+
+ChunkMap::const_iterator ChunkMap::end( void ) const
+{
+	return const_iterator( slots.data() + slots.size(), slots.data() + slots.size() );
+}
+
+
+ChunkMap::const_iterator::const_iterator( const Slot* slot, const Slot* end ) :
+	slot( slot ),
+	end( end )
+{
+	skip();
+}
+
+
+/*!
+ * Advances past empty slots.
+ */
+void ChunkMap::const_iterator::skip( void )
+{
+	while ( slot != end && !slot->chunk )
+		slot++;
+}
+
+
+const ChunkMap::Slot& ChunkMap::const_iterator::operator*( void ) const
+{
+	return *slot;
+}
+
+
+const ChunkMap::Slot* ChunkMap::const_iterator::operator->( void ) const
+{
+	return slot;
+}
+
+
+ChunkMap::const_iterator& ChunkMap::const_iterator::operator++( void )
+{
+	slot++;
+	skip();
+
+	return *this;
+}
+
+
+bool ChunkMap::const_iterator::operator!=( const const_iterator& other ) const
+{
+	return slot != other.slot;
+}
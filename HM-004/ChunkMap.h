@@ -0,0 +1,104 @@
+#pragma once
+
+
+class Chunk;
+
+
+/*!
+ * Flat open-addressing hash table from chunk coordinates to chunks. Keys are
+ * the three coordinates packed into 21 bits each; collisions are resolved by
+ * linear probing, and removal uses backward-shift deletion so lookups never
+ * need tombstones.
+ */
+class ChunkMap {
+public:
+	struct Slot {
+		unsigned long long key;
+		glm::ivec3 position;
+		Chunk* chunk;
+	};
+
+	class const_iterator {
+	private:
+		const Slot* slot;
+		const Slot* end;
+
+		void skip( void );
+
+	public:
+		const_iterator( const Slot* slot, const Slot* end );
+
+		const Slot& operator*( void ) const;
+		const Slot* operator->( void ) const;
+		const_iterator& operator++( void );
+		bool operator!=( const const_iterator& other ) const;
+	};
+
+private:
+	std::vector<Slot> slots;
+	unsigned int mask;
+	int count;
+
+	static unsigned long long pack( glm::ivec3 pos );
+	static unsigned int hash( unsigned long long key );
+
+	void rehash( int capacity );
+
+public:
+	ChunkMap( int capacity = 64 );
+
+	Chunk* find( glm::ivec3 pos ) const;
+	void insert( glm::ivec3 pos, Chunk* chunk );
+	bool remove( glm::ivec3 pos );
+	void clear( void );
+
+	int size( void ) const;
+
+	const_iterator begin( void ) const;
+	const_iterator end( void ) const;
+};
+
+
+/*!
+ * Packs chunk coordinates into a 63 bit key, 21 bits per axis.
+ */
+inline unsigned long long ChunkMap::pack( glm::ivec3 pos )
+{
+	return   (unsigned long long) ( pos.x & 0x1FFFFF )
+	     | ( (unsigned long long) ( pos.y & 0x1FFFFF ) << 21 )
+	     | ( (unsigned long long) ( pos.z & 0x1FFFFF ) << 42 );
+}
+
+
+/*!
+ * Mixes a packed key into a 32 bit hash (the 64 bit finaliser from MurmurHash3).
+ */
+inline unsigned int ChunkMap::hash( unsigned long long key )
+{
+	key ^= key >> 33;
+	key *= 0xFF51AFD7ED558CCDULL;
+	key ^= key >> 33;
+	key *= 0xC4CEB9FE1A85EC53ULL;
+	key ^= key >> 33;
+
+	return (unsigned int) key;
+}
+
+
+/*!
+ * Returns the chunk at the given chunk coordinates, or null if there is
+ * none. Never inserts.
+ */
+inline Chunk* ChunkMap::find( glm::ivec3 pos ) const
+{
+	unsigned long long key = pack( pos );
+
+	for ( unsigned int i = hash( key ) & mask; ; i = ( i + 1 ) & mask )
+	{
+		const Slot& s = slots[i];
+		if ( !s.chunk )
+			return nullptr;
+		if ( s.key == key )
+			return s.chunk;
+	}
+}
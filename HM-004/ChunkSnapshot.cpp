@@ -0,0 +1,92 @@
+#include "Base.h"
+#include "ChunkSnapshot.h"
+
+#include "Chunk.h"
+#include "Terrain.h"
+
+
+/*!
+ * Allocates a snapshot buffer for chunks of the given size.
+ */
+ChunkSnapshot::ChunkSnapshot( int size ) :
+	blocks( ( size + 2 ) * ( size + 2 ) * ( size + 2 ) ),
+	scratch( size * size * size ),
+	size( size ),
+	padded( size + 2 ),
+	uniform( false )
+{
+}
+
+
+/*!
+ * Copies a chunk and the facing layer of each of its neighbours into the
+ * snapshot, in one pass. Missing neighbours read as air, as does the whole
+ * border if terrain is null.
+ */
+void ChunkSnapshot::capture( const Chunk* chunk, Terrain* terrain )
+{
+	Block air = { 0 };
+	std::fill( blocks.begin(), blocks.end(), air );
+
+	// Interior, a row of z at a time.
+	uniform = chunk->isUniform();
+	chunk->unpack( &scratch[0] );
+	for ( int x = 0; x < size; x++ )
+	for ( int y = 0; y < size; y++ )
+	{
+		memcpy(
+			&blocks[( ( x + 1 ) * padded + y + 1 ) * padded + 1],
+			&scratch[( x * size + y ) * size],
+			sizeof ( Block ) * size
+		);
+	}
+
+	if ( !terrain )
+		return;
+
+	// Border, one face neighbour at a time.
+	glm::ivec3 position = chunk->getPosition();
+	for ( int d = 0; d < 3; d++ )
+	{
+		int u = ( d == 0 ) ? 2 : 0;
+		int v = ( d == 1 ) ? 2 : 1;
+
+		for ( int side = 0; side < 2; side++ )
+		{
+			glm::ivec3 offset( 0 );
+			offset[d] = side ? 1 : -1;
+
+			const Chunk* n = terrain->getChunkAt( position + offset );
+			if ( !n )
+				continue;
+
+			// Layer of the neighbour touching this chunk, and where it goes.
+			glm::ivec3 src, dst;
+			src[d] = side ? 0 : size - 1;
+			dst[d] = side ? size : -1;
+
+			for ( src[u] = dst[u] = 0; src[u] < size; src[u]++, dst[u]++ )
+			for ( src[v] = dst[v] = 0; src[v] < size; src[v]++, dst[v]++ )
+				blocks[( ( dst.x + 1 ) * padded + dst.y + 1 ) * padded + dst.z + 1] = n->getBlockAt( src );
+		}
+	}
+}
+
+
+/*!
+ * Returns true if the captured chunk, excluding its border, held a single
+ * block id.
+ */
+bool ChunkSnapshot::isUniform( void ) const
+{
+	return uniform;
+}
+
+
+/*!
+ * Returns the size of the captured chunk, excluding its border.
+ */
+int ChunkSnapshot::getSize( void ) const
+{
+	return size;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+
+#include "BlockStorage.h"
+
+
+class Chunk;
+class Terrain;
+
+
+/*!
+ * A copy of one chunk's blocks plus a one block border taken from its six
+ * face neighbours, stored linearly as [x][y][z] in a (size + 2)^3 buffer.
+ * Coordinates run from -1 to size inclusive. The mesher reads only from
+ * this, so it never touches Terrain or the live chunk storage.
+ *
+ * Edge and corner padding is left as air, as the mesher never reads it.
+ */
+class ChunkSnapshot {
+private:
+	std::vector<Block> blocks;
+	std::vector<Block> scratch;
+	int size;
+	int padded;
+
+	bool uniform;
+
+public:
+	ChunkSnapshot( int size );
+
+	void capture( const Chunk* chunk, Terrain* terrain );
+
+	char get( int x, int y, int z ) const;
+	char get( glm::ivec3 pos ) const;
+
+	bool isUniform( void ) const;
+	int  getSize( void ) const;
+};
+
+
+/*!
+ * Returns the block id at a chunk-local position, which may lie one block
+ * outside the chunk on any single axis.
+ */
+inline char ChunkSnapshot::get( int x, int y, int z ) const
+{
+	return blocks[( ( x + 1 ) * padded + y + 1 ) * padded + z + 1].id;
+}
+
+
+inline char ChunkSnapshot::get( glm::ivec3 pos ) const
+{
+	return get( pos.x, pos.y, pos.z );
+}
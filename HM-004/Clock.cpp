@@ -0,0 +1,42 @@
+#include "Base.h"
+#include "Clock.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+
+/*!
+ * Returns the time in seconds from an arbitrary fixed point.
+ */
+double Clock::now( void )
+{
+#ifdef _WIN32
+	static double period = 0.0;
+	LARGE_INTEGER count;
+
+	if ( period == 0.0 )
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency( &frequency );
+		period = 1.0 / frequency.QuadPart;
+	}
+
+	QueryPerformanceCounter( &count );
+
+	return count.QuadPart * period;
+#else
+	timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
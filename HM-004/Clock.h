@@ -0,0 +1,12 @@
+#pragma once
+
+
+/*!
+ * A monotonic high resolution clock. Unlike glfwGetTime it needs no GLFW
+ * initialisation, and so no display, which lets generation and meshing be
+ * timed on headless machines.
+ */
+class Clock {
+public:
+	static double now( void );
+};
@@ -0,0 +1,23 @@
+#include "Base.h"
+#include "ColumnData.h"
+
+
+/*!
+ * Allocates column data for chunks of the given size.
+ */
+ColumnData::ColumnData( int size ) :
+	slope( size * size ),
+	surface( size * size ),
+	seal( size * size ),
+	size( size )
+{
+}
+
+
+/*!
+ * Returns the width of the column in blocks.
+ */
+int ColumnData::getSize( void ) const
+{
+	return size;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+
+/*!
+ * Generation values that depend only on (x, z), computed once for a column of
+ * chunks and shared by every chunk stacked in it: the island's slope, the
+ * hill surface height built on it, and the height of the sealing layer.
+ * Stored as [x][z] over one chunk's footprint, and filled in by the column
+ * stages of a GenPipeline.
+ */
+class ColumnData {
+private:
+	std::vector<float> slope;
+	std::vector<float> surface;
+	std::vector<int>   seal;
+	int size;
+
+public:
+	ColumnData( int size );
+
+	float getSlope( int x, int z ) const;
+	float getSurface( int x, int z ) const;
+	int   getSeal( int x, int z ) const;
+
+	void setSlope( int x, int z, float height );
+	void setSurface( int x, int z, float height );
+	void setSeal( int x, int z, int height );
+
+	int getSize( void ) const;
+};
+
+
+/*!
+ * Returns the island's base height at this chunk-local column, before hills.
+ */
+inline float ColumnData::getSlope( int x, int z ) const
+{
+	return slope[x * size + z];
+}
+
+
+/*!
+ * Returns the world height below which this chunk-local column is solid.
+ */
+inline float ColumnData::getSurface( int x, int z ) const
+{
+	return surface[x * size + z];
+}
+
+
+/*!
+ * Returns the world height below which this chunk-local column is sealed.
+ */
+inline int ColumnData::getSeal( int x, int z ) const
+{
+	return seal[x * size + z];
+}
+
+
+inline void ColumnData::setSlope( int x, int z, float height )
+{
+	slope[x * size + z] = height;
+}
+
+
+inline void ColumnData::setSurface( int x, int z, float height )
+{
+	surface[x * size + z] = height;
+}
+
+
+inline void ColumnData::setSeal( int x, int z, int height )
+{
+	seal[x * size + z] = height;
+}
@@ -4,6 +4,10 @@
 
 #include "Base.h"
 
+#include <thread>
+#include <chrono>
+#include <exception>
+
 #include "Renderer.h"
 #include "Camera.h"
 #include "Mesh.h"
@@ -12,6 +16,7 @@
 #include "State.h"
 #include "Player.h"
 #include "Input.h"
+#include "LoadProgress.h"
 #include "Terrain.h"
 
 
@@ -22,7 +27,7 @@ Core::Core( void )
 {
 	// Initialise GLFW.
 	if ( !glfwInit() )
-		throw std::exception( "GLFW failed to initialise." );
+		throw std::runtime_error( "GLFW failed to initialise." );
 	else
 		std::cout << "GLFW successfully initialised.\n";
 
@@ -52,7 +57,7 @@ Core::Core( void )
 	{
 		glfwTerminate();
 
-		throw std::exception( "Window failed to open." );
+		throw std::runtime_error( "Window failed to open." );
 	}
 	else
 		std::cout << "Window opened successfully.\n";
@@ -65,7 +70,7 @@ Core::Core( void )
 	if ( glewInit() != GLEW_OK )
 	{
 		glfwTerminate();
-		throw std::exception( "GLEW failed to initalise." );
+		throw std::runtime_error( "GLEW failed to initalise." );
 	}
 	else
 		std::cout << "GLEW successfully initialised.\n\n";
@@ -89,6 +94,8 @@ Core::Core( void )
 bool Core::exists = false;
 Core* Core::instance;
 
+double Core::progressDue = 0.0;
+
 
 /*!
 * Returns a pointer to the core instance. Creates one if it does not exist.
@@ -113,9 +120,34 @@ void Core::run( void )
 	Core* core = getInstance();
 	getRenderer()->setup();
 
-	// Dummy terrain.
-	Terrain terrain;
-	terrain.addToRenderer( getRenderer() );
+	// Dummy terrain, generated on a loading thread while this one shows the
+	// progress screen. Closing the window cancels the load.
+	LoadProgress progress;
+	Terrain* terrain = nullptr;
+	std::exception_ptr error;
+
+	std::thread loader( [&]
+	{
+		try
+		{
+			terrain = new Terrain( WorldGenParams(), TRN_GEN_THREADS, &progress );
+		} catch ( ... )
+		{
+			error = std::current_exception();
+		}
+
+		progress.finish();
+	} );
+
+	waitForLoad( &progress );
+	loader.join();
+
+	if ( error )
+		std::rethrow_exception( error );
+
+	// Chunks are meshed in the background and appear as they are uploaded.
+	if ( !progress.isCancelled() )
+		getRenderer()->addTerrain( terrain );
 
 	// Dummy state.
 	setState( new State() );
@@ -165,7 +197,10 @@ void Core::run( void )
 		glfwSwapBuffers( core->renderer->window );
 	}
 
+	getRenderer()->stopMeshing();
+
 	delete core->state;
+	delete terrain;
 
 	glfwDestroyWindow( core->renderer->window );
 	glfwTerminate();
@@ -174,47 +209,65 @@ void Core::run( void )
 
 /*!
 * Allows intensive operations to prevent the window becoming unresponsive.
+* Returns false once the window has been asked to close.
 */
-void Core::cheapUpdate( void )
+bool Core::cheapUpdate( void )
 {
 	glfwPollEvents();
 
-	Core* core = getInstance();
-
-	if ( glfwWindowShouldClose( core->renderer->window ) )
-	{
-		glfwDestroyWindow( core->renderer->window );
-		glfwTerminate();
-
-		exit( EXIT_SUCCESS );
-	}
+	return !glfwWindowShouldClose( getInstance()->renderer->window );
 }
 
 
 /*!
-* Allows intensive operations to prevent the window becoming unresponsive.
-* Draws a progress bar using OpenGL direct mode.
+* Keeps the window responsive during a load on this thread, and redraws the
+* progress screen from the load's counters at most WIN_PROGRESS_FPS times per
+* second, so it may be called as often as convenient. If the window has been
+* asked to close, cancels the load and returns false.
 */
-void Core::cheapProgress( std::string name, float progress )
+bool Core::updateProgress( LoadProgress* progress )
 {
-	glfwPollEvents();
+	double now = glfwGetTime();
+	if ( now < progressDue )
+		return !progress->isCancelled();
 
-	Core* core = getInstance();
+	progressDue = now + 1.0 / WIN_PROGRESS_FPS;
 
-	if ( glfwWindowShouldClose( core->renderer->window ) )
+	if ( !cheapUpdate() )
 	{
-		glfwDestroyWindow( core->renderer->window );
-		glfwTerminate();
-
-		exit( EXIT_SUCCESS );
+		progress->cancel();
+		return false;
 	}
 
 	glClearColor( 0.0f, 0.0f, 0.0f, 1.0f );
 	glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
-	Core::getRenderer()->renderProgress( name, progress );
+	Core::getRenderer()->renderProgress( progress->getName(), progress->getFraction() );
+
+	glfwSwapBuffers( getInstance()->renderer->window );
+
+	return true;
+}
+
+
+/*!
+* Shows the progress screen until a load on another thread finishes, sleeping
+* between redraws. Returns false if the window was closed, in which case the
+* load has been cancelled but may still be winding down.
+*/
+bool Core::waitForLoad( LoadProgress* progress )
+{
+	while ( !progress->isFinished() )
+	{
+		if ( !updateProgress( progress ) )
+			return false;
+
+		double wait = progressDue - glfwGetTime();
+		if ( wait > 0.0 )
+			std::this_thread::sleep_for( std::chrono::microseconds( (long long) ( wait * 1e6 ) ) );
+	}
 
-	glfwSwapBuffers( core->renderer->window );
+	return true;
 }
 
 
@@ -4,6 +4,7 @@
 class Renderer;
 class State;
 class Input;
+class LoadProgress;
 
 
 class Core {
@@ -14,14 +15,17 @@ private:
 	static Core* instance;
 	static Core* getInstance( void );
 
+	static double progressDue;
+
 	Renderer* renderer;
 	State*    state{ nullptr };
 	Input*    input;
 
 public:
 	static void run( void );
-	static void cheapUpdate( void );
-	static void cheapProgress( std::string name, float progress = 0 );
+	static bool cheapUpdate( void );
+	static bool updateProgress( LoadProgress* progress );
+	static bool waitForLoad( LoadProgress* progress );
 
 	static Renderer* getRenderer( void );
 
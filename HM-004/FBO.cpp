@@ -3,11 +3,7 @@
 #include "Base.h"
 #include "FBO.h"
 
-
-/*!
- * Stores the ID of the currently bound FBO.
- */
-GLuint FBO::bound = 0;
+#include "GLState.h"
 
 
 /*!
@@ -28,7 +24,7 @@ FBO::FBO( bool derived )
 		bind();
 		bindTexture();
 		{
-			glActiveTexture( GL_TEXTURE0 + 1 );
+			GLState::activeTexture( 1 );
 			glTexImage2D(    GL_TEXTURE_2D, 0, GL_RGB, WIN_W, WIN_H, 0, GL_RGB, GL_UNSIGNED_BYTE, 0 );
 			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
 			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
@@ -42,12 +38,12 @@ FBO::FBO( bool derived )
 			glDrawBuffers( 1, draw_buffers );
 
 			if ( glCheckFramebufferStatus( GL_FRAMEBUFFER ) != GL_FRAMEBUFFER_COMPLETE )
-				throw std::exception( "Failed to create framebuffer." );
+				throw std::runtime_error( "Failed to create framebuffer." );
 		}
 		unbind();
 		unbindTexture();
 
-		glActiveTexture( GL_TEXTURE0 );
+		GLState::activeTexture( 0 );
 	}
 }
 
@@ -57,8 +53,8 @@ FBO::FBO( bool derived )
  */
 void FBO::bind( void )
 {
-	glBindFramebuffer(  GL_FRAMEBUFFER,  bound = ID );
-	glBindRenderbuffer( GL_RENDERBUFFER, depthID    );
+	GLState::bindFramebuffer( ID );
+	GLState::bindRenderbuffer( depthID );
 	glViewport( 0, 0, WIN_W, WIN_H );
 }
 
@@ -68,20 +64,18 @@ void FBO::bind( void )
  */
 void FBO::unbind( void )
 {
-	glBindFramebuffer(  GL_FRAMEBUFFER,  bound = 0 );
-	glBindRenderbuffer( GL_RENDERBUFFER, 0         );
+	GLState::bindFramebuffer( 0 );
+	GLState::bindRenderbuffer( 0 );
 	glViewport( 0, 0, WIN_W, WIN_H );
 }
 
 
 /*!
- * Binds the texture to texture unit 1 for rendering.
+ * Binds the texture to texture unit 1 for rendering, leaving unit 1 active.
  */
 void FBO::bindTexture( void )
 {
-	glActiveTexture( GL_TEXTURE0 + 1          );
-	glBindTexture(   GL_TEXTURE_2D, textureID );
-	glActiveTexture( GL_TEXTURE0              );
+	GLState::bindTexture( 1, GL_TEXTURE_2D, textureID );
 }
 
 
@@ -90,9 +84,7 @@ void FBO::bindTexture( void )
  */
 void FBO::unbindTexture( void )
 {
-	glActiveTexture( GL_TEXTURE0 + 1  );
-	glBindTexture(   GL_TEXTURE_2D, 0 );
-	glActiveTexture( GL_TEXTURE0      );
+	GLState::bindTexture( 1, GL_TEXTURE_2D, 0 );
 }
 
 
@@ -108,7 +100,7 @@ ShadowMap::ShadowMap( void ) :
 	bind();
 	bindTexture();
 	{
-		glActiveTexture( GL_TEXTURE0 + 1 );
+		GLState::activeTexture( 1 );
 		glTexImage2D(
 			GL_TEXTURE_2D,
 			0,
@@ -134,12 +126,12 @@ ShadowMap::ShadowMap( void ) :
 		glDrawBuffer( GL_NONE );
 
 		if ( glCheckFramebufferStatus( GL_FRAMEBUFFER ) != GL_FRAMEBUFFER_COMPLETE )
-			throw std::exception( "Failed to create shadow map framebuffer." );
+			throw std::runtime_error( "Failed to create shadow map framebuffer." );
 	}
 	unbind();
 	unbindTexture();
 
-	glActiveTexture( GL_TEXTURE0 );
+	GLState::activeTexture( 0 );
 }
 
 
@@ -148,7 +140,7 @@ ShadowMap::ShadowMap( void ) :
  */
 void ShadowMap::bind( void )
 {
-	glBindFramebuffer(  GL_FRAMEBUFFER,  bound = ID );
-	glBindRenderbuffer( GL_RENDERBUFFER, 0          );
+	GLState::bindFramebuffer( ID );
+	GLState::bindRenderbuffer( 0 );
 	glViewport( 0, 0, 512, 512 );
 }
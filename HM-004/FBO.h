@@ -3,8 +3,7 @@
 
 class FBO {
 protected:
-	static GLuint bound;
-	       GLuint ID, textureID, depthID;
+	GLuint ID, textureID, depthID;
 
 public:
 	FBO( bool derived = false );
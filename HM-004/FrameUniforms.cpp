@@ -0,0 +1,48 @@
+#include "Base.h"
+#include "FrameUniforms.h"
+
+#include "GLState.h"
+
+
+// Uniform buffer binding point of the Frame block.
+#define FU_BINDING 0
+
+
+GLuint FrameUniforms::ID = 0;
+
+
+/*!
+ * Points the program's Frame block, if it has one, at the shared buffer.
+ * Returns true if the program uses the block.
+ */
+bool FrameUniforms::attach( GLuint program )
+{
+	GLuint block = glGetUniformBlockIndex( program, "Frame" );
+
+	if ( block == GL_INVALID_INDEX )
+		return false;
+
+	glUniformBlockBinding( program, block, FU_BINDING );
+
+	return true;
+}
+
+
+/*!
+ * Uploads this frame's constants. The buffer is created and bound to the
+ * Frame binding point on first use; later uploads replace its storage
+ * whole, so the driver need not wait for draws still reading the last one.
+ */
+void FrameUniforms::update( const FrameData& data )
+{
+	bool created = !ID;
+	if ( created )
+		glGenBuffers( 1, &ID );
+
+	GLState::bindBuffer( GL_UNIFORM_BUFFER, ID );
+	glBufferData( GL_UNIFORM_BUFFER, sizeof ( FrameData ), &data, GL_STREAM_DRAW );
+
+	// Also binds the buffer to the generic target, where it already is.
+	if ( created )
+		glBindBufferBase( GL_UNIFORM_BUFFER, FU_BINDING, ID );
+}
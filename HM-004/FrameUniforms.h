@@ -0,0 +1,30 @@
+#pragma once
+
+
+/*!
+ * Constants shared by every draw in a frame, laid out to match the std140
+ * Frame uniform block in the shaders. The normal matrix is a mat3, whose
+ * columns std140 pads to four floats each.
+ */
+struct FrameData {
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec4 normal[3];
+	glm::vec4 lightDir;
+	glm::vec4 lightColor;
+};
+
+
+/*!
+ * One uniform buffer holding the FrameData, uploaded once per frame and read
+ * by every shader that declares the Frame block. Chunk offsets come from the
+ * TerrainArena's buffer texture, so nothing is sent per chunk.
+ */
+class FrameUniforms {
+private:
+	static GLuint ID;
+
+public:
+	static bool attach( GLuint program );
+	static void update( const FrameData& data );
+};
@@ -0,0 +1,183 @@
+#include "Base.h"
+#include "Frustum.h"
+
+#ifdef TRN_SIMD
+#include <xmmintrin.h>
+#endif
+
+
+/*!
+ * Removes every box.
+ */
+void BoxList::clear( void )
+{
+	cx.clear(); cy.clear(); cz.clear();
+	ex.clear(); ey.clear(); ez.clear();
+}
+
+
+/*!
+ * Appends a box given by its minimum and maximum corners.
+ */
+void BoxList::add( glm::vec3 min, glm::vec3 max )
+{
+	glm::vec3 c = ( min + max ) * 0.5f;
+	glm::vec3 e = ( max - min ) * 0.5f;
+
+	cx.push_back( c.x ); cy.push_back( c.y ); cz.push_back( c.z );
+	ex.push_back( e.x ); ey.push_back( e.y ); ez.push_back( e.z );
+}
+
+
+/*!
+ * Returns the number of boxes.
+ */
+int BoxList::size( void ) const
+{
+	return (int) cx.size();
+}
+
+
+/*!
+ * Creates a frustum that rejects nothing until extracted.
+ */
+Frustum::Frustum( void )
+{
+	for ( int i = 0; i < 6; i++ )
+		nx[i] = ny[i] = nz[i] = d[i] = 0.0f;
+}
+
+
+/*!
+ * Takes the planes from a projection times view matrix (Gribb and Hartmann),
+ * so boxes are tested in world space. Each plane is a sum or difference of
+ * the fourth row and one of the others.
+ */
+void Frustum::extract( const glm::mat4& m )
+{
+	for ( int i = 0; i < 6; i++ )
+	{
+		int row = i / 2;
+		float sign = ( i & 1 ) ? -1.0f : 1.0f;
+
+		glm::vec4 p(
+			m[0][3] + sign * m[0][row],
+			m[1][3] + sign * m[1][row],
+			m[2][3] + sign * m[2][row],
+			m[3][3] + sign * m[3][row]
+		);
+		p = p * ( 1.0f / glm::length( glm::vec3( p ) ) );
+
+		nx[i] = p.x;
+		ny[i] = p.y;
+		nz[i] = p.z;
+		d[i]  = p.w;
+	}
+}
+
+
+/*!
+ * Returns false if the box lies wholly outside any plane. Boxes that merely
+ * straddle a corner may pass, which is safe.
+ */
+bool Frustum::test( glm::vec3 min, glm::vec3 max ) const
+{
+	glm::vec3 c = ( min + max ) * 0.5f;
+	glm::vec3 e = ( max - min ) * 0.5f;
+
+	// Same order of operations as cull(), so both agree on every box.
+	for ( int i = 0; i < 6; i++ )
+	{
+		float dist   = ( nx[i] * c.x + ny[i] * c.y ) + ( nz[i] * c.z + d[i] );
+		float radius = ( fabsf( nx[i] ) * e.x + fabsf( ny[i] ) * e.y ) + fabsf( nz[i] ) * e.z;
+		if ( dist + radius < 0.0f )
+			return false;
+	}
+
+	return true;
+}
+
+
+/*!
+ * Tests every box, setting visible[n] to 1 or 0, and returns the number
+ * visible. Works through four boxes at a time against each plane when built
+ * with TRN_SIMD, which needs nothing beyond SSE.
+ */
+int Frustum::cull( const BoxList& boxes, unsigned char* visible ) const
+{
+#ifdef TRN_SIMD
+	int count = boxes.size();
+	int shown = 0;
+	int n = 0;
+
+	__m128 sign = _mm_set1_ps( -0.0f );
+	for ( ; n + 4 <= count; n += 4 )
+	{
+		__m128 cx = _mm_loadu_ps( &boxes.cx[n] );
+		__m128 cy = _mm_loadu_ps( &boxes.cy[n] );
+		__m128 cz = _mm_loadu_ps( &boxes.cz[n] );
+		__m128 ex = _mm_loadu_ps( &boxes.ex[n] );
+		__m128 ey = _mm_loadu_ps( &boxes.ey[n] );
+		__m128 ez = _mm_loadu_ps( &boxes.ez[n] );
+
+		__m128 outside = _mm_setzero_ps();
+		for ( int i = 0; i < 6; i++ )
+		{
+			__m128 px = _mm_set1_ps( nx[i] );
+			__m128 py = _mm_set1_ps( ny[i] );
+			__m128 pz = _mm_set1_ps( nz[i] );
+
+			__m128 dist = _mm_add_ps(
+				_mm_add_ps( _mm_mul_ps( px, cx ), _mm_mul_ps( py, cy ) ),
+				_mm_add_ps( _mm_mul_ps( pz, cz ), _mm_set1_ps( d[i] ) )
+			);
+			__m128 radius = _mm_add_ps(
+				_mm_add_ps( _mm_mul_ps( _mm_andnot_ps( sign, px ), ex ), _mm_mul_ps( _mm_andnot_ps( sign, py ), ey ) ),
+				_mm_mul_ps( _mm_andnot_ps( sign, pz ), ez )
+			);
+
+			// dist < -radius, written as dist + radius < 0.
+			outside = _mm_or_ps( outside, _mm_cmplt_ps( _mm_add_ps( dist, radius ), _mm_setzero_ps() ) );
+		}
+
+		int mask = _mm_movemask_ps( outside );
+		for ( int k = 0; k < 4; k++ )
+		{
+			visible[n + k] = ( mask >> k & 1 ) ? 0 : 1;
+			shown += visible[n + k];
+		}
+	}
+
+	// The last few boxes one at a time.
+	for ( ; n < count; n++ )
+	{
+		glm::vec3 c( boxes.cx[n], boxes.cy[n], boxes.cz[n] );
+		glm::vec3 e( boxes.ex[n], boxes.ey[n], boxes.ez[n] );
+		visible[n] = test( c - e, c + e ) ? 1 : 0;
+		shown += visible[n];
+	}
+
+	return shown;
+#else
+	return cullScalar( boxes, visible );
+#endif
+}
+
+
+/*!
+ * Tests every box one at a time, as cull() does without TRN_SIMD.
+ */
+int Frustum::cullScalar( const BoxList& boxes, unsigned char* visible ) const
+{
+	int shown = 0;
+
+	for ( int n = 0; n < boxes.size(); n++ )
+	{
+		glm::vec3 c( boxes.cx[n], boxes.cy[n], boxes.cz[n] );
+		glm::vec3 e( boxes.ex[n], boxes.ey[n], boxes.ez[n] );
+		visible[n] = test( c - e, c + e ) ? 1 : 0;
+		shown += visible[n];
+	}
+
+	return shown;
+}
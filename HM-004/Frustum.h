@@ -0,0 +1,39 @@
+#pragma once
+
+
+#include "MacroTerrain.h"
+
+
+/*!
+ * Axis-aligned boxes stored as separate arrays of centres and half extents,
+ * so Frustum::cull can load four boxes per register.
+ */
+struct BoxList {
+	std::vector<float> cx, cy, cz;
+	std::vector<float> ex, ey, ez;
+
+	void clear( void );
+	void add( glm::vec3 min, glm::vec3 max );
+	int  size( void ) const;
+};
+
+
+/*!
+ * The six planes of a view frustum, extracted from a projection times view
+ * matrix, for rejecting boxes that cannot be seen. Planes face inwards and
+ * are normalised.
+ */
+class Frustum {
+private:
+	// Left, right, bottom, top, near, far.
+	float nx[6], ny[6], nz[6], d[6];
+
+public:
+	Frustum( void );
+
+	void extract( const glm::mat4& viewProjection );
+
+	bool test( glm::vec3 min, glm::vec3 max ) const;
+	int  cull( const BoxList& boxes, unsigned char* visible ) const;
+	int  cullScalar( const BoxList& boxes, unsigned char* visible ) const;
+};
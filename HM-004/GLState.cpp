@@ -0,0 +1,304 @@
+#include "Base.h"
+#include "GLState.h"
+
+
+// Marks a binding or flag whose current value is not known.
+#define GS_UNKNOWN 0xffffffff
+
+
+GLuint GLState::program      = GS_UNKNOWN;
+GLuint GLState::vertexArray  = GS_UNKNOWN;
+GLuint GLState::buffers[3]   = { GS_UNKNOWN, GS_UNKNOWN, GS_UNKNOWN };
+GLuint GLState::unit         = GS_UNKNOWN;
+GLuint GLState::textures[GS_TEXTURE_UNITS][3] = {
+	{ GS_UNKNOWN, GS_UNKNOWN, GS_UNKNOWN }, { GS_UNKNOWN, GS_UNKNOWN, GS_UNKNOWN },
+	{ GS_UNKNOWN, GS_UNKNOWN, GS_UNKNOWN }, { GS_UNKNOWN, GS_UNKNOWN, GS_UNKNOWN }
+};
+GLuint GLState::framebuffer  = GS_UNKNOWN;
+GLuint GLState::renderbuffer = GS_UNKNOWN;
+GLint  GLState::flags[5]     = { -1, -1, -1, -1, -1 };
+
+GLStateStats GLState::stats = { 0, 0 };
+
+
+/*!
+ * Returns the index of a buffer target in buffers, or -1 if it is not
+ * tracked.
+ */
+int GLState::bufferSlot( GLenum target )
+{
+	switch ( target )
+	{
+	case GL_ARRAY_BUFFER:         return 0;
+	case GL_ELEMENT_ARRAY_BUFFER: return 1;
+	case GL_UNIFORM_BUFFER:       return 2;
+	default:                      return -1;
+	}
+}
+
+
+/*!
+ * Returns the index of a texture target in textures, or -1 if it is not
+ * tracked.
+ */
+int GLState::textureSlot( GLenum target )
+{
+	switch ( target )
+	{
+	case GL_TEXTURE_2D:       return 0;
+	case GL_TEXTURE_2D_ARRAY: return 1;
+	case GL_TEXTURE_BUFFER:   return 2;
+	default:                  return -1;
+	}
+}
+
+
+/*!
+ * Returns the index of a capability in flags, or -1 if it is not tracked.
+ */
+int GLState::flagSlot( GLenum cap )
+{
+	switch ( cap )
+	{
+	case GL_DEPTH_TEST:        return 0;
+	case GL_CULL_FACE:         return 1;
+	case GL_BLEND:             return 2;
+	case GL_TEXTURE_2D:        return 3;
+	case GL_PRIMITIVE_RESTART: return 4;
+	default:                   return -1;
+	}
+}
+
+
+/*!
+ * Records a new value for a piece of state, returning false, and counting a
+ * skip, if it already held it.
+ */
+bool GLState::change( GLuint* current, GLuint value )
+{
+	if ( *current == value )
+	{
+		stats.skipped++;
+		return false;
+	}
+
+	*current = value;
+	stats.changes++;
+
+	return true;
+}
+
+
+/*!
+ * Makes the given program current, 0 for none.
+ */
+void GLState::useProgram( GLuint id )
+{
+	if ( change( &program, id ) )
+		glUseProgram( id );
+}
+
+
+/*!
+ * Binds the given vertex array, 0 for none. The element array binding
+ * belongs to the vertex array, so it becomes unknown.
+ */
+void GLState::bindVertexArray( GLuint id )
+{
+	if ( change( &vertexArray, id ) )
+	{
+		glBindVertexArray( id );
+		buffers[1] = GS_UNKNOWN;
+	}
+}
+
+
+/*!
+ * Binds a buffer to the given target.
+ */
+void GLState::bindBuffer( GLenum target, GLuint id )
+{
+	int slot = bufferSlot( target );
+
+	if ( slot < 0 )
+	{
+		stats.changes++;
+		glBindBuffer( target, id );
+	} else if ( change( &buffers[slot], id ) )
+		glBindBuffer( target, id );
+}
+
+
+/*!
+ * Selects the texture unit that texture calls apply to.
+ */
+void GLState::activeTexture( GLuint unit )
+{
+	if ( change( &GLState::unit, unit ) )
+		glActiveTexture( GL_TEXTURE0 + unit );
+}
+
+
+/*!
+ * Binds a texture to the given target of a texture unit, leaving that unit
+ * active.
+ */
+void GLState::bindTexture( GLuint unit, GLenum target, GLuint id )
+{
+	int slot = textureSlot( target );
+
+	if ( slot < 0 || unit >= GS_TEXTURE_UNITS )
+	{
+		activeTexture( unit );
+		stats.changes++;
+		glBindTexture( target, id );
+	} else if ( textures[unit][slot] == id )
+		stats.skipped++;
+	else
+	{
+		activeTexture( unit );
+		change( &textures[unit][slot], id );
+		glBindTexture( target, id );
+	}
+}
+
+
+/*!
+ * Binds the given framebuffer, 0 for the window.
+ */
+void GLState::bindFramebuffer( GLuint id )
+{
+	if ( change( &framebuffer, id ) )
+		glBindFramebuffer( GL_FRAMEBUFFER, id );
+}
+
+
+/*!
+ * Binds the given renderbuffer, 0 for none.
+ */
+void GLState::bindRenderbuffer( GLuint id )
+{
+	if ( change( &renderbuffer, id ) )
+		glBindRenderbuffer( GL_RENDERBUFFER, id );
+}
+
+
+/*!
+ * Enables a capability.
+ */
+void GLState::enable( GLenum cap )
+{
+	int slot = flagSlot( cap );
+
+	if ( slot >= 0 && flags[slot] == 1 )
+	{
+		stats.skipped++;
+		return;
+	}
+
+	if ( slot >= 0 )
+		flags[slot] = 1;
+
+	stats.changes++;
+	glEnable( cap );
+}
+
+
+/*!
+ * Disables a capability.
+ */
+void GLState::disable( GLenum cap )
+{
+	int slot = flagSlot( cap );
+
+	if ( slot >= 0 && flags[slot] == 0 )
+	{
+		stats.skipped++;
+		return;
+	}
+
+	if ( slot >= 0 )
+		flags[slot] = 0;
+
+	stats.changes++;
+	glDisable( cap );
+}
+
+
+/*!
+ * Deletes a buffer. GL unbinds a deleted buffer, and its name may be
+ * reused, so any binding of it is forgotten too.
+ */
+void GLState::deleteBuffer( GLuint id )
+{
+	for ( int i = 0; i < 3; i++ )
+		if ( buffers[i] == id )
+			buffers[i] = 0;
+
+	glDeleteBuffers( 1, &id );
+}
+
+
+/*!
+ * Deletes a vertex array, forgetting its binding as for deleteBuffer().
+ */
+void GLState::deleteVertexArray( GLuint id )
+{
+	if ( vertexArray == id )
+	{
+		vertexArray = 0;
+		buffers[1]  = GS_UNKNOWN;
+	}
+
+	glDeleteVertexArrays( 1, &id );
+}
+
+
+/*!
+ * Returns the current program, as last set through useProgram().
+ */
+GLuint GLState::getProgram( void )
+{
+	return program;
+}
+
+
+/*!
+ * Forgets all tracked state, so that the next change of each is issued.
+ */
+void GLState::invalidate( void )
+{
+	program      = GS_UNKNOWN;
+	vertexArray  = GS_UNKNOWN;
+	unit         = GS_UNKNOWN;
+	framebuffer  = GS_UNKNOWN;
+	renderbuffer = GS_UNKNOWN;
+
+	for ( int i = 0; i < 3; i++ )
+		buffers[i] = GS_UNKNOWN;
+
+	for ( int u = 0; u < GS_TEXTURE_UNITS; u++ )
+		textures[u][0] = textures[u][1] = textures[u][2] = GS_UNKNOWN;
+
+	for ( int f = 0; f < 5; f++ )
+		flags[f] = -1;
+}
+
+
+/*!
+ * Returns the counts since the last resetStats().
+ */
+const GLStateStats& GLState::getStats( void )
+{
+	return stats;
+}
+
+
+/*!
+ * Zeroes the counts, e.g. at the start of a frame.
+ */
+void GLState::resetStats( void )
+{
+	stats.changes = 0;
+	stats.skipped = 0;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+
+// Texture units whose bindings are tracked.
+#define GS_TEXTURE_UNITS 4
+
+
+/*!
+ * Counts of GL state changes since the last GLState::resetStats(): those
+ * passed on to GL, and those skipped as already current.
+ */
+struct GLStateStats {
+	int changes;
+	int skipped;
+};
+
+
+/*!
+ * Tracks the GL binding and enable state the renderer uses: the program,
+ * vertex array, buffers, textures per unit, framebuffers and capability
+ * flags. Every GL wrapper binds through here, so a bind of what is already
+ * bound costs nothing. State starts unknown, so the first change of each is
+ * always issued.
+ *
+ * Anything making GL calls of its own, such as fontstash, must call
+ * invalidate() afterwards.
+ */
+class GLState {
+private:
+	static GLuint program;
+	static GLuint vertexArray;
+	static GLuint buffers[3];
+	static GLuint unit;
+	static GLuint textures[GS_TEXTURE_UNITS][3];
+	static GLuint framebuffer;
+	static GLuint renderbuffer;
+	static GLint  flags[5];
+
+	static GLStateStats stats;
+
+	static int bufferSlot( GLenum target );
+	static int textureSlot( GLenum target );
+	static int flagSlot( GLenum cap );
+
+	static bool change( GLuint* current, GLuint value );
+
+public:
+	static void useProgram( GLuint id );
+	static void bindVertexArray( GLuint id );
+	static void bindBuffer( GLenum target, GLuint id );
+	static void activeTexture( GLuint unit );
+	static void bindTexture( GLuint unit, GLenum target, GLuint id );
+	static void bindFramebuffer( GLuint id );
+	static void bindRenderbuffer( GLuint id );
+	static void enable( GLenum cap );
+	static void disable( GLenum cap );
+
+	static void deleteBuffer( GLuint id );
+	static void deleteVertexArray( GLuint id );
+
+	static GLuint getProgram( void );
+
+	static void invalidate( void );
+
+	static const GLStateStats& getStats( void );
+	static void resetStats( void );
+};
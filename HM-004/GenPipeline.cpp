@@ -0,0 +1,283 @@
+#include "Base.h"
+#include "GenPipeline.h"
+
+#include "Chunk.h"
+#include "Clock.h"
+#include "ColumnData.h"
+
+
+// Per-voxel stages are timed on one row in this many.
+#define GEN_TIMING_STRIDE 16
+
+
+/*!
+ * Creates a stage with the given name, which runs per column, per voxel or
+ * both.
+ */
+GenStage::GenStage( std::string name, bool perColumn, bool perVoxel ) :
+	name( name ),
+	perColumn( perColumn ),
+	perVoxel( perVoxel ),
+	nanoseconds( 0 )
+{
+}
+
+
+GenStage::~GenStage( void )
+{
+}
+
+
+/*!
+ * Fills in this stage's values for the column of chunks at (cx, cz).
+ */
+void GenStage::column( int, int, ColumnData* )
+{
+}
+
+
+/*!
+ * Edits a row of blocks in place.
+ */
+void GenStage::voxels( const GenRow&, Block* )
+{
+}
+
+
+/*!
+ * Returns how many floats of data this stage keeps per chunk, handed to it
+ * as GenRow::data and zeroed before each chunk. Stages that keep none
+ * return 0.
+ */
+int GenStage::getChunkDataSize( int ) const
+{
+	return 0;
+}
+
+
+bool GenStage::isPerColumn( void ) const
+{
+	return perColumn;
+}
+
+
+bool GenStage::isPerVoxel( void ) const
+{
+	return perVoxel;
+}
+
+
+const std::string& GenStage::getName( void ) const
+{
+	return name;
+}
+
+
+/*!
+ * Adds to the time spent in this stage. Safe to call from any thread.
+ */
+void GenStage::addTime( double seconds )
+{
+	nanoseconds += (long long) ( seconds * 1e9 );
+}
+
+
+/*!
+ * Returns the total time spent in this stage, in seconds, summed over all
+ * threads.
+ */
+double GenStage::getTime( void ) const
+{
+	return nanoseconds / 1e9;
+}
+
+
+void GenStage::resetTime( void )
+{
+	nanoseconds = 0;
+}
+
+
+/*!
+ * Creates an empty pipeline for chunks of the given size.
+ */
+GenPipeline::GenPipeline( int size ) :
+	size( size ),
+	timing( false ),
+	clockCost( 0.0 )
+{
+}
+
+
+/*!
+ * Deletes every stage.
+ */
+GenPipeline::~GenPipeline( void )
+{
+	for ( auto s : stages )
+		delete s;
+}
+
+
+/*!
+ * Appends a stage, taking ownership of it.
+ */
+void GenPipeline::add( GenStage* stage )
+{
+	stages.push_back( stage );
+}
+
+
+/*!
+ * Runs every per-column stage, in order, for the column of chunks at chunk
+ * coordinates (cx, cz).
+ */
+void GenPipeline::generateColumn( int cx, int cz, ColumnData* column )
+{
+	for ( auto s : stages )
+	{
+		if ( !s->isPerColumn() )
+			continue;
+
+		double start = timing ? Clock::now() : 0.0;
+		s->column( cx, cz, column );
+		if ( timing )
+			s->addTime( Clock::now() - start );
+	}
+}
+
+
+/*!
+ * Builds a chunk in one traversal: each row of blocks starts as air and goes
+ * through every per-voxel stage in turn, and the finished blocks are loaded
+ * into the chunk's storage at once. Column must already be generated.
+ */
+void GenPipeline::generateChunk( Chunk* chunk, const ColumnData& column )
+{
+	std::vector<Block> blocks( size * size * size );
+	std::vector<float> scratch( size * 4 );
+	std::vector<double> elapsed( stages.size(), 0.0 );
+
+	// Per-chunk data for each stage, zeroed for every chunk.
+	std::vector<int> offsets( stages.size() );
+	int total = 0;
+	for ( int i = 0; i < (int) stages.size(); i++ )
+	{
+		offsets[i] = total;
+		total += stages[i]->getChunkDataSize( size );
+	}
+	std::vector<float> data( total + 1, 0.0f );
+
+	GenRow row;
+	row.size    = size;
+	row.column  = &column;
+	row.scratch = &scratch[0];
+
+	glm::ivec3 origin = chunk->getPosition() * size;
+
+	for ( row.x = 0; row.x < size; row.x++ )
+	for ( row.y = 0; row.y < size; row.y++ )
+	{
+		row.world = origin + glm::ivec3( row.x, row.y, 0 );
+		Block* out = &blocks[( row.x * size + row.y ) * size];
+
+		if ( !timing || ( row.x * size + row.y ) % GEN_TIMING_STRIDE )
+		{
+			for ( int i = 0; i < (int) stages.size(); i++ )
+			{
+				if ( !stages[i]->isPerVoxel() )
+					continue;
+
+				row.data = &data[offsets[i]];
+				stages[i]->voxels( row, out );
+			}
+
+			continue;
+		}
+
+		// Each stage's time runs from the end of the one before it.
+		double last = Clock::now();
+		for ( int i = 0; i < (int) stages.size(); i++ )
+		{
+			if ( !stages[i]->isPerVoxel() )
+				continue;
+
+			row.data = &data[offsets[i]];
+			stages[i]->voxels( row, out );
+
+			double now = Clock::now();
+			elapsed[i] += std::max( now - last - clockCost, 0.0 );
+			last = now;
+		}
+	}
+
+	chunk->load( &blocks[0] );
+
+	// Scale the sampled rows up to the whole chunk.
+	if ( timing )
+		for ( int i = 0; i < (int) stages.size(); i++ )
+			if ( stages[i]->isPerVoxel() )
+				stages[i]->addTime( elapsed[i] * GEN_TIMING_STRIDE );
+}
+
+
+/*!
+ * Turns the per-stage timing counters on or off. Per-voxel stages are timed
+ * on one row in every GEN_TIMING_STRIDE and scaled up, as a clock read per
+ * stage on every row would cost more than most stages do; even so timing is
+ * off by default.
+ */
+void GenPipeline::setTiming( bool timing )
+{
+	this->timing = timing;
+
+	// Measure the clock itself, so that reading it is not charged to stages.
+	if ( timing )
+	{
+		const int reads = 1000;
+		double start = Clock::now();
+		for ( int i = 1; i < reads; i++ )
+			Clock::now();
+		clockCost = ( Clock::now() - start ) / reads;
+	}
+}
+
+
+void GenPipeline::resetTimings( void )
+{
+	for ( auto s : stages )
+		s->resetTime();
+}
+
+
+/*!
+ * Prints the time spent in each stage, summed over all threads.
+ */
+void GenPipeline::printTimings( void ) const
+{
+	double total = 0.0;
+	for ( auto s : stages )
+		total += s->getTime();
+
+	std::cout << "Generation stages:\n";
+	for ( auto s : stages )
+	{
+		std::cout << std::fixed << std::setprecision( 2 )
+		          << "  " << std::left << std::setw( 12 ) << s->getName() << std::right
+		          << std::setw( 9 ) << s->getTime() * 1e3 << " ms "
+		          << std::setw( 6 ) << ( total > 0.0 ? s->getTime() / total * 100 : 0.0 ) << "%\n";
+	}
+	std::cout << "\n";
+}
+
+
+int GenPipeline::getStageCount( void ) const
+{
+	return (int) stages.size();
+}
+
+
+GenStage* GenPipeline::getStage( int i ) const
+{
+	return stages[i];
+}
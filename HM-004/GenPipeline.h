@@ -0,0 +1,90 @@
+#pragma once
+
+
+#include "BlockStorage.h"
+
+
+class Chunk;
+class ColumnData;
+
+
+/*!
+ * A row of blocks along z handed to the per-voxel stages, with everything a
+ * stage needs to know about where it lies.
+ */
+struct GenRow {
+	int x, y;                 // Chunk-local position of the row; z runs from 0.
+	glm::ivec3 world;         // World position of the row's first block.
+	int size;                 // Blocks in the row.
+	const ColumnData* column; // Column data for the chunk's column.
+	float* scratch;           // Four rows of floats for the stage's own use.
+	float* data;              // The stage's per-chunk data; see getChunkDataSize().
+};
+
+
+/*!
+ * One step of world generation. A stage may work per column, filling in the
+ * ColumnData shared by every chunk stacked in that column, per voxel, editing
+ * rows of blocks in place, or both. Per-voxel stages see the blocks as every
+ * earlier stage left them, and must only depend on the blocks in their row
+ * and on column data, so that stages can be fused and chunks built in any
+ * order on any thread.
+ */
+class GenStage {
+private:
+	std::string name;
+	bool perColumn;
+	bool perVoxel;
+
+	std::atomic<long long> nanoseconds;
+
+public:
+	GenStage( std::string name, bool perColumn, bool perVoxel );
+	virtual ~GenStage( void );
+
+	virtual void column( int cx, int cz, ColumnData* column );
+	virtual void voxels( const GenRow& row, Block* blocks );
+
+	virtual int getChunkDataSize( int size ) const;
+
+	bool isPerColumn( void ) const;
+	bool isPerVoxel( void ) const;
+
+	const std::string& getName( void ) const;
+
+	void   addTime( double seconds );
+	double getTime( void ) const;
+	void   resetTime( void );
+};
+
+
+/*!
+ * An ordered list of generation stages, run fused: each chunk is built in a
+ * single traversal, every per-voxel stage running on a row before moving to
+ * the next row, and the result is written straight into chunk storage.
+ * Generating columns and chunks is thread-safe.
+ */
+class GenPipeline {
+private:
+	std::vector<GenStage*> stages;
+	int size;
+
+	bool   timing;
+	double clockCost;
+
+public:
+	GenPipeline( int size );
+	~GenPipeline( void );
+
+	void add( GenStage* stage );
+
+	void generateColumn( int cx, int cz, ColumnData* column );
+	void generateChunk( Chunk* chunk, const ColumnData& column );
+
+	void setTiming( bool timing );
+	void resetTimings( void );
+	void printTimings( void ) const;
+
+	int       getStageCount( void ) const;
+	GenStage* getStage( int i ) const;
+};
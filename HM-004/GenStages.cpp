@@ -0,0 +1,248 @@
+#include "Base.h"
+#include "GenStages.h"
+
+#include "ColumnData.h"
+#include "Noise.h"
+
+
+HillStage::HillStage( const WorldGenParams& params ) :
+	GenStage( "hills", true, true ),
+	params( params ),
+	offset( params.getOffset( 1 ) )
+{
+}
+
+
+/*!
+ * Works out the slope and surface height of every column, with the noise
+ * taken a row of z at a time.
+ */
+void HillStage::column( int cx, int cz, ColumnData* column )
+{
+	int size = column->getSize();
+	std::vector<float> xs( size ), zs( size ), noise( size );
+
+	for ( int z = 0; z < size; z++ )
+		zs[z] = (float) ( ( z + cz * size ) / (double) params.hillScale ) + offset.z;
+
+	for ( int x = 0; x < size; x++ )
+	{
+		int ix = x + cx * size;
+
+		std::fill( xs.begin(), xs.end(), (float) ( ix / (double) params.hillScale ) + offset.x );
+		Noise::simplex( &xs[0], &zs[0], &noise[0], size );
+
+		for ( int z = 0; z < size; z++ )
+		{
+			int kz = z + cz * size;
+
+			float slope = params.islandHeight - sqrtf(
+				powf( 1 - ix / params.islandRadius, 4 ) +
+				powf( 1 - kz / params.islandRadius, 4 ) ) * params.islandFalloff;
+			column->setSlope( x, z, slope );
+			column->setSurface( x, z, slope + ( noise[z] + 1 ) * params.hillHeight );
+		}
+	}
+}
+
+
+void HillStage::voxels( const GenRow& row, Block* blocks )
+{
+	for ( int z = 0; z < row.size; z++ )
+		blocks[z].id = row.world.y < row.column->getSurface( row.x, z ) ? 3 : 0;
+}
+
+
+/*!
+ * Creates a cave stage that takes noise every caveStride blocks, or at every
+ * block if it is 1.
+ */
+CaveStage::CaveStage( const WorldGenParams& params ) :
+	GenStage( "caves", false, true ),
+	params( params ),
+	offset( params.getOffset( 2 ) ),
+	stride( params.caveStride > 1 ? params.caveStride : 1 ),
+	samples( 0 )
+{
+}
+
+
+/*!
+ * Rounds a division towards negative infinity.
+ */
+static inline int floorDiv( int a, int b )
+{
+	return a >= 0 ? a / b : -( ( -a + b - 1 ) / b );
+}
+
+
+/*!
+ * Fills values, as [x][y][z], with the noise at n^3 lattice points starting
+ * from the given lattice coordinates.
+ */
+void CaveStage::lattice( glm::ivec3 base, int n, float* values )
+{
+	std::vector<float> xs( n ), ys( n ), zs( n );
+	for ( int z = 0; z < n; z++ )
+		zs[z] = (float) ( ( base.z + z ) * stride / (double) params.caveScale ) + offset.z;
+
+	for ( int x = 0; x < n; x++ )
+	for ( int y = 0; y < n; y++ )
+	{
+		std::fill( xs.begin(), xs.end(), (float) ( ( base.x + x ) * stride / (double) params.caveScale ) + offset.x );
+		std::fill( ys.begin(), ys.end(), (float) ( ( base.y + y ) * stride / (double) params.caveScale ) + offset.y );
+		Noise::simplex( &xs[0], &ys[0], &zs[0], &values[( x * n + y ) * n], n );
+	}
+
+	samples += n * n * n;
+}
+
+
+/*!
+ * Carving only ever turns blocks to air, so rows with nothing solid in them
+ * are skipped without taking any noise. With a lattice, it is only sampled
+ * once the first solid row of a chunk turns up, so chunks of open sky never
+ * sample it at all.
+ */
+void CaveStage::voxels( const GenRow& row, Block* blocks )
+{
+	bool solid = false;
+	for ( int z = 0; z < row.size; z++ )
+		solid |= blocks[z].id != 0;
+
+	if ( !solid )
+		return;
+
+	float* noise = row.scratch + row.size * 3;
+
+	if ( stride == 1 )
+	{
+		float* xs = row.scratch;
+		float* ys = row.scratch + row.size;
+		float* zs = row.scratch + row.size * 2;
+
+		for ( int z = 0; z < row.size; z++ )
+		{
+			xs[z] = (float) ( row.world.x / (double) params.caveScale ) + offset.x;
+			ys[z] = (float) ( row.world.y / (double) params.caveScale ) + offset.y;
+			zs[z] = (float) ( ( row.world.z + z ) / (double) params.caveScale ) + offset.z;
+		}
+
+		Noise::simplex( xs, ys, zs, noise, row.size );
+		samples += row.size;
+	} else
+	{
+		// Lattice covering the chunk, in lattice coordinates. Each axis may
+		// meet it at a different phase, so it is sized, as in
+		// getChunkDataSize(), for the widest any of them can need.
+		glm::ivec3 origin = row.world - glm::ivec3( row.x, row.y, 0 );
+		glm::ivec3 base( floorDiv( origin.x, stride ), floorDiv( origin.y, stride ), floorDiv( origin.z, stride ) );
+		int n = ( row.size + stride - 1 ) / stride + 2;
+
+		// The first float flags whether the lattice has been sampled yet.
+		float* values = row.data + 1;
+		if ( row.data[0] == 0.0f )
+		{
+			lattice( base, n, values );
+			row.data[0] = 1.0f;
+		}
+
+		// Blend the four lattice lines around this row into one along z.
+		int   gx = floorDiv( row.world.x, stride ) - base.x;
+		int   gy = floorDiv( row.world.y, stride ) - base.y;
+		float fx = (float) ( row.world.x - ( gx + base.x ) * stride ) / stride;
+		float fy = (float) ( row.world.y - ( gy + base.y ) * stride ) / stride;
+
+		float* line = row.scratch;
+		const float* l00 = &values[( ( gx     ) * n + gy     ) * n];
+		const float* l01 = &values[( ( gx     ) * n + gy + 1 ) * n];
+		const float* l10 = &values[( ( gx + 1 ) * n + gy     ) * n];
+		const float* l11 = &values[( ( gx + 1 ) * n + gy + 1 ) * n];
+		for ( int z = 0; z < n; z++ )
+		{
+			float a = l00[z] + ( l01[z] - l00[z] ) * fy;
+			float b = l10[z] + ( l11[z] - l10[z] ) * fy;
+			line[z] = a + ( b - a ) * fx;
+		}
+
+		for ( int z = 0; z < row.size; z++ )
+		{
+			int wz = row.world.z + z;
+			int gz = floorDiv( wz, stride ) - base.z;
+			float fz = (float) ( wz - ( gz + base.z ) * stride ) / stride;
+
+			noise[z] = line[gz] + ( line[gz + 1] - line[gz] ) * fz;
+		}
+	}
+
+	for ( int z = 0; z < row.size; z++ )
+		if ( noise[z] - row.world.y / (double) params.caveFalloff > 0 )
+			blocks[z].id = 0;
+}
+
+
+/*!
+ * Room for the lattice of a chunk, however it is aligned, plus a flag.
+ */
+int CaveStage::getChunkDataSize( int size ) const
+{
+	if ( stride == 1 )
+		return 0;
+
+	int n = ( size + stride - 1 ) / stride + 2;
+
+	return 1 + n * n * n;
+}
+
+
+int CaveStage::getStride( void ) const
+{
+	return stride;
+}
+
+
+/*!
+ * Returns the number of noise samples taken so far, over all threads.
+ */
+long long CaveStage::getSamples( void ) const
+{
+	return samples;
+}
+
+
+SealStage::SealStage( const WorldGenParams& params ) :
+	GenStage( "seal", true, true ),
+	params( params ),
+	offset( params.getOffset( 3 ) )
+{
+}
+
+
+/*!
+ * Works out the depth of the sealing layer under every column.
+ */
+void SealStage::column( int cx, int cz, ColumnData* column )
+{
+	int size = column->getSize();
+	std::vector<float> xs( size ), zs( size ), noise( size );
+
+	for ( int z = 0; z < size; z++ )
+		zs[z] = (float) ( ( z + cz * size ) / (double) params.sealScale ) + offset.z;
+
+	for ( int x = 0; x < size; x++ )
+	{
+		std::fill( xs.begin(), xs.end(), (float) ( ( x + cx * size ) / (double) params.sealScale ) + offset.x );
+		Noise::simplex( &xs[0], &zs[0], &noise[0], size );
+
+		for ( int z = 0; z < size; z++ )
+			column->setSeal( x, z, (int) ( ( noise[z] + 1 ) * 4 + 1 ) );
+	}
+}
+
+
+void SealStage::voxels( const GenRow& row, Block* blocks )
+{
+	for ( int z = 0; z < row.size; z++ )
+		if ( row.world.y >= 0 && row.world.y < row.column->getSeal( row.x, z ) )
+			blocks[z].id = 1;
+}
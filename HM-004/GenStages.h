@@ -0,0 +1,71 @@
+#pragma once
+
+
+#include "MacroTerrain.h"
+#include "GenPipeline.h"
+#include "WorldGenParams.h"
+
+
+/*!
+ * The island's slope with noise hills on top. Works out the surface height
+ * of each column, then fills everything below it with solid blocks.
+ */
+class HillStage : public GenStage {
+private:
+	WorldGenParams params;
+	glm::vec3 offset;
+
+public:
+	HillStage( const WorldGenParams& params );
+
+	void column( int cx, int cz, ColumnData* column );
+	void voxels( const GenRow& row, Block* blocks );
+};
+
+
+/*!
+ * Carves caves out of solid blocks wherever 3D noise, biased towards open
+ * space higher up, is positive.
+ *
+ * With a stride (WorldGenParams::caveStride) above 1 the noise is only taken on a lattice of points that
+ * many blocks apart, and trilinearly interpolated in between. The lattice
+ * lies on world coordinates, so neighbouring chunks share the points along
+ * their border and caves meet without seams. The noise's features are 30
+ * blocks across, so a stride of 4 loses little detail for far fewer samples.
+ */
+class CaveStage : public GenStage {
+private:
+	WorldGenParams params;
+	glm::vec3 offset;
+	int stride;
+
+	std::atomic<long long> samples;
+
+	void lattice( glm::ivec3 base, int n, float* values );
+
+public:
+	CaveStage( const WorldGenParams& params );
+
+	void voxels( const GenRow& row, Block* blocks );
+	int  getChunkDataSize( int size ) const;
+
+	int       getStride( void ) const;
+	long long getSamples( void ) const;
+};
+
+
+/*!
+ * Seals the bottom of the world with a layer of uneven depth, so that caves
+ * never open onto the void.
+ */
+class SealStage : public GenStage {
+private:
+	WorldGenParams params;
+	glm::vec3 offset;
+
+public:
+	SealStage( const WorldGenParams& params );
+
+	void column( int cx, int cz, ColumnData* column );
+	void voxels( const GenRow& row, Block* blocks );
+};
@@ -0,0 +1,127 @@
+#include "Base.h"
+#include "Headless.h"
+
+#include "Chunk.h"
+#include "Clock.h"
+#include "Mesher.h"
+#include "MesherWorkspace.h"
+#include "Noise.h"
+#include "Terrain.h"
+#include "TerrainMesh.h"
+#include "ThreadPool.h"
+
+
+/*!
+ * Runs the report, printing results to the console.
+ */
+void Headless::run( void )
+{
+	generate();
+}
+
+
+/*!
+ * Generates the default island on every hardware thread, then meshes every
+ * chunk on one thread and again on all of them.
+ */
+void Headless::generate( void )
+{
+	const int hardware = ThreadPool::getHardwareThreads();
+	WorldGenParams params;
+
+	std::cout << "Headless terrain report\n"
+	          << "  world:   " << params.width << "x" << params.height << "x" << params.depth
+	          << " chunks of " << TRN_CHUNK_SIZE << "^3, seed " << params.seed << "\n"
+	          << "  threads: " << hardware << ", noise " << Noise::getPathName( Noise::getPath() )
+#ifdef TRN_PALETTE
+	          << ", palette storage"
+#else
+	          << ", flat storage"
+#endif
+#ifdef TRN_MORTON
+	          << ", Morton order"
+#endif
+	          << ", " << ( Mesher::getType() == MESHER_BINARY ? "binary" : "greedy" ) << " mesher\n\n";
+
+	// Generation.
+	double start = Clock::now();
+	Terrain* terrain = new Terrain( params, hardware );
+	double generated = Clock::now() - start;
+
+	std::vector<Chunk*> chunks;
+	size_t blockBytes = 0;
+	int uniform = 0;
+	for ( auto& c : terrain->getChunks() )
+	{
+		chunks.push_back( c.chunk );
+		blockBytes += c.chunk->getStorage().getMemoryUsage();
+		uniform    += c.chunk->isUniform();
+	}
+
+	int count = (int) chunks.size();
+	double voxels = (double) count * TRN_CHUNK_SIZE * TRN_CHUNK_SIZE * TRN_CHUNK_SIZE;
+
+	std::cout << std::fixed << std::setprecision( 2 )
+	          << "Generation\n"
+	          << "  " << generated * 1e3 << " ms, " << voxels / generated / 1e6 << " Mvoxels/s\n"
+	          << "  " << count << " chunks, " << uniform << " uniform, "
+	          << blockBytes / 1024.0 << " KiB of blocks\n"
+	          << "  world hash " << std::hex << terrain->getHash() << std::dec << "\n\n";
+
+	// Meshing on this thread alone.
+	MeshData data;
+	size_t quads = 0, vertexBytes = 0, indexBytes = 0;
+	int meshed = 0;
+
+	start = Clock::now();
+	for ( auto c : chunks )
+	{
+		if ( !c->buildMesh( &data ) )
+			continue;
+
+		meshed++;
+		quads       += data.vertices.size() / 4;
+		vertexBytes += data.vertices.size() * sizeof ( TerrainVertex );
+		indexBytes  += data.indices.size()  * sizeof ( GLuint );
+	}
+	double serial = Clock::now() - start;
+
+	// Meshing on every hardware thread.
+	std::vector<size_t> parallelQuads( count, 0 );
+	{
+		ThreadPool pool( hardware );
+
+		start = Clock::now();
+		for ( int n = 0; n < count; n++ )
+		{
+			pool.submit( [&chunks, &parallelQuads, n]
+			{
+				MeshData& data = MesherWorkspace::local()->mesh;
+				if ( chunks[n]->buildMesh( &data ) )
+					parallelQuads[n] = data.vertices.size() / 4;
+			} );
+		}
+		pool.wait();
+	}
+	double parallel = Clock::now() - start;
+
+	size_t total = 0;
+	for ( auto q : parallelQuads )
+		total += q;
+
+	std::cout << std::fixed << std::setprecision( 2 )
+	          << "Meshing\n"
+	          << "  1 thread:   " << serial * 1e3 << " ms, "
+	          << serial / count * 1e6 << " us/chunk, "
+	          << quads / serial / 1e6 << " Mquads/s\n"
+	          << "  " << std::setw( 2 ) << hardware << " threads: " << parallel * 1e3 << " ms, "
+	          << serial / parallel << "x, "
+	          << ( total == quads ? "identical" : "MISMATCH" ) << "\n"
+	          << "  " << meshed << " of " << count << " chunks meshed, "
+	          << quads << " quads, " << ( meshed ? quads / meshed : 0 ) << " per meshed chunk\n"
+	          << "  " << vertexBytes / 1024.0 << " KiB of vertices, "
+	          << indexBytes / 1024.0 << " KiB of indices, "
+	          << (double) ( vertexBytes + indexBytes ) / ( quads ? quads : 1 ) << " bytes per quad\n\n";
+
+	delete terrain;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+
+/*!
+ * Generates the world, meshes every chunk and reports timings, quad counts
+ * and memory, without GLFW, a window or a GL context, so terrain work can be
+ * profiled on machines with no display. Runs in place of the game when built
+ * with HEADLESS_MODE, as the hm004-headless target of CMakeLists.txt does.
+ *
+ * Only Main, Headless, Clock, LoadProgress, ThreadPool and the terrain sources
+ * (Terrain, Chunk, ChunkMap, ChunkSnapshot, BlockStorage, Mesher,
+ * MesherWorkspace, Noise, NoiseSSE4, NoiseAVX2, ColumnData, GenPipeline,
+ * GenStages, WorldGenParams) are linked, none of which call GL or GLFW.
+ * TerrainMesh is used for its header alone. Built that way, with WINDOWLESS,
+ * Base.h includes only GLM and GL/gl.h, for GL's types, and neither GLEW nor
+ * GLFW.
+ */
+class Headless {
+private:
+	static void generate( void );
+
+public:
+	static void run( void );
+};
@@ -0,0 +1,86 @@
+#include "Base.h"
+#include "LoadProgress.h"
+
+
+LoadProgress::LoadProgress( void ) :
+	name( "Loading..." ),
+	done( 0 ),
+	total( 0 ),
+	cancelled( false ),
+	finished( false )
+{
+}
+
+
+/*!
+ * Starts a new pass of the given number of steps. Called from the loading
+ * thread only.
+ */
+void LoadProgress::begin( const char* name, int total )
+{
+	this->done  = 0;
+	this->total = total;
+	this->name  = name;
+}
+
+
+/*!
+ * Marks one step of the current pass as done. Safe from any thread.
+ */
+void LoadProgress::advance( void )
+{
+	done++;
+}
+
+
+/*!
+ * Marks the whole load as over, whether it completed or was cancelled.
+ */
+void LoadProgress::finish( void )
+{
+	finished = true;
+}
+
+
+/*!
+ * Asks the loading thread to stop as soon as it can.
+ */
+void LoadProgress::cancel( void )
+{
+	cancelled = true;
+}
+
+
+bool LoadProgress::isCancelled( void ) const
+{
+	return cancelled;
+}
+
+
+bool LoadProgress::isFinished( void ) const
+{
+	return finished;
+}
+
+
+/*!
+ * Returns the name of the current pass, for display.
+ */
+const char* LoadProgress::getName( void ) const
+{
+	return name;
+}
+
+
+/*!
+ * Returns how far through the current pass the load is, from 0 to 1. The
+ * counters are read separately, so this may briefly be off as a pass begins.
+ */
+float LoadProgress::getFraction( void ) const
+{
+	int d = done, t = total;
+	if ( t <= 0 )
+		return 0.0f;
+
+	return d >= t ? 1.0f : (float) d / t;
+}
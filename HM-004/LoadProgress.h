@@ -0,0 +1,32 @@
+#pragma once
+
+
+/*!
+ * Progress of a long load, shared between the thread doing the work and the
+ * main thread showing it. The loading thread starts each pass with begin()
+ * and calls advance() as its jobs complete, then finish() when it is done;
+ * the main thread reads the counters at its own pace, and may cancel(), after
+ * which the loading thread skips any work left and finishes early.
+ */
+class LoadProgress {
+private:
+	std::atomic<const char*> name;
+	std::atomic<int>  done;
+	std::atomic<int>  total;
+	std::atomic<bool> cancelled;
+	std::atomic<bool> finished;
+
+public:
+	LoadProgress( void );
+
+	void begin( const char* name, int total );
+	void advance( void );
+	void finish( void );
+	void cancel( void );
+
+	bool isCancelled( void ) const;
+	bool isFinished( void ) const;
+
+	const char* getName( void ) const;
+	float       getFraction( void ) const;
+};
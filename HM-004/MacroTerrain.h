@@ -0,0 +1,54 @@
+#pragma once
+
+
+#define TRN_CHUNK_SIZE 16
+
+#define TRN_BLOCK_ALIGN 64
+
+// Threads used to generate terrain. Zero uses one per hardware thread.
+#define TRN_GEN_THREADS 0
+
+// Threads used to mesh chunks for the renderer. Zero uses one per hardware
+// thread. See MeshQueue.
+#define TRN_MESH_THREADS 0
+
+// Blocks between cave noise samples, which are interpolated in between. 1
+// samples every block exactly. See CaveStage.
+#define TRN_CAVE_STRIDE 1
+
+// Voxel index order inside chunk storage. When TRN_MORTON is defined blocks
+// are stored in Z-order, which keeps all six neighbours of a block close in
+// memory but requires a power-of-two chunk size. Otherwise blocks are stored
+// linearly as [x][y][z], with z varying fastest.
+//#define TRN_MORTON
+
+// Store chunk voxels as bit-packed indices into a per-chunk palette of block
+// ids, rather than one byte per block. See PaletteStorage.
+#define TRN_PALETTE
+
+// Build the SSE4.1 and AVX2 noise kernels. Which one runs is decided from the
+// CPU at startup; this only needs turning off for non-x86 targets.
+#if defined( _M_IX86 ) || defined( _M_X64 ) || defined( __i386__ ) || defined( __x86_64__ )
+#define TRN_SIMD
+#endif
+
+// Draw terrain as plain quads of four vertices, indexed through one shared
+// triangle list (see QuadIndexBuffer), instead of giving every chunk its own
+// index buffer of primitive restart fans.
+#define TRN_QUAD_INDICES
+
+// Vertices the TerrainArena makes room for at first. It doubles when full.
+#define TRN_ARENA_VERTICES ( 1 << 20 )
+
+// Fraction of the TerrainArena left in holes by replaced meshes at which it
+// is repacked.
+#define TRN_ARENA_DEFRAG 0.25
+
+// Size of the depth buffer the OcclusionCuller draws occluders into, in
+// pixels. The width must be a multiple of four.
+#define TRN_OCCLUSION_WIDTH  256
+#define TRN_OCCLUSION_HEIGHT 128
+
+// Threads used to draw occluders and test chunks against them. Zero uses one
+// per hardware thread.
+#define TRN_OCCLUSION_THREADS 0
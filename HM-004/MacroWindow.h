@@ -18,6 +18,13 @@
 
 #define WIN_TITLE "HM-004"
 
+// Redraws per second of the loading screen.
+#define WIN_PROGRESS_FPS 30
+
+// Milliseconds per frame spent uploading meshed chunks. At least one chunk
+// is uploaded per frame whatever the budget. See Renderer::uploadTerrain.
+#define WIN_UPLOAD_BUDGET 2.0
+
 #define WIN_CLOSED  0
 #define WIN_PENDING 1
 #define WIN_OPEN    2
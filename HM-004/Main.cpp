@@ -4,9 +4,15 @@
 #include "Base.h"
 #include "Main.h"
 
+#include "Headless.h"
+#include "MicroBenchmark.h"
+#include "Tests.h"
+
 
 /*!
- * Starting point for the process. Calls setup and main loop.
+ * Starting point for the process. Calls setup and main loop, or runs the
+ * windowless terrain report instead when built with HEADLESS_MODE, or the
+ * JSON microbenchmarks with MICROBENCH_MODE, or the tests with TEST_MODE.
  *
  * @return Program exit state.
  */
@@ -14,7 +20,16 @@ int main( void )
 {
 	try
 	{
+#if defined( HEADLESS_MODE )
+		Headless::run();
+#elif defined( MICROBENCH_MODE )
+		MicroBenchmark::run();
+#elif defined( TEST_MODE )
+		if ( !Tests::run() )
+			return EXIT_FAILURE;
+#else
 		Core::run();
+#endif
 
 	} catch( std::exception& e )
 	{
@@ -1,13 +1,14 @@
 #include "Base.h"
 #include "Mesh.h"
 
+#include "GLState.h"
 #include "VAO.h"
 
 
 /*!
  * Creates a vbo and an ibo and buffers given data to them.
  */
-Mesh::Mesh( std::vector<vertex> vertices, std::vector<GLuint> indices, GLenum poly_mode ) :
+Mesh::Mesh( const std::vector<vertex>& vertices, const std::vector<GLuint>& indices, GLenum poly_mode ) :
 	poly_mode( poly_mode ),
 	count( (int) indices.size() ),
 	vao( new VAO() ),
@@ -77,7 +78,7 @@ Mesh::Mesh( std::vector<vertex> vertices, std::vector<GLuint> indices, GLenum po
 /*!
  * Rebuffers data without creating a new VBO.
  */
-void Mesh::rebuffer( std::vector<vertex> vertices, std::vector<GLuint> indices, GLenum poly_mode )
+void Mesh::rebuffer( const std::vector<vertex>& vertices, const std::vector<GLuint>& indices, GLenum poly_mode )
 {
 	this->poly_mode = poly_mode;
 	count = (int) indices.size();
@@ -109,8 +110,8 @@ void Mesh::rebuffer( std::vector<vertex> vertices, std::vector<GLuint> indices,
  */
 void Mesh::bind( void )
 {
-	glBindBuffer( GL_ARRAY_BUFFER,        vertexID );
-	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, indexID );
+	GLState::bindBuffer( GL_ARRAY_BUFFER,        vertexID );
+	GLState::bindBuffer( GL_ELEMENT_ARRAY_BUFFER, indexID );
 }
 
 
@@ -119,13 +120,14 @@ void Mesh::bind( void )
  */
 void Mesh::unbind( void )
 {
-	glBindBuffer( GL_ARRAY_BUFFER, 0 );
-	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+	GLState::bindBuffer( GL_ARRAY_BUFFER, 0 );
+	GLState::bindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
 }
 
 
 /*!
- * Renders the mesh to the back buffer.
+ * Renders the mesh to the back buffer. Its vertex array is left bound, so
+ * the caller unbinds it once after drawing a batch of meshes.
  */
 void Mesh::draw( void )
 {
@@ -134,9 +136,6 @@ void Mesh::draw( void )
 		vao->bind();
 
 		glDrawElements( poly_mode, count, GL_UNSIGNED_INT, (GLvoid*) 0 );
-
-		vao->unbind();
-		unbind();
 	}
 }
 
@@ -225,7 +224,7 @@ void Mesh::rotate( float amount )
 /*!
  * Instantiate a mesh from the given arguments.
  */
-LerpMesh::LerpMesh( std::vector<vertex> vertices, std::vector<GLuint> indices, GLenum poly_mode ) :
+LerpMesh::LerpMesh( const std::vector<vertex>& vertices, const std::vector<GLuint>& indices, GLenum poly_mode ) :
 	Mesh( vertices, indices, poly_mode )
 {
 }
@@ -499,25 +498,6 @@ void Mesh::appendCube( glm::vec3 position, float size, cube faces, std::vector<v
 }
 
 
-/*!
- * Appends the vertices and indices of a single given 2d quad to a 3d mesh, using an up vector.
- */
-void Mesh::appendQuad( quad q, std::vector<vertex>* v, std::vector<GLuint>* i )
-{
-	vertex v_face[4] = {
-		{ q.p0.x, q.p0.y, q.p0.z,   0.0,  0.0, (GLfloat)  q.t,   q.n.x, q.n.y, q.n.z },
-		{ q.p1.x, q.p1.y, q.p1.z,   q.w,  0.0, (GLfloat)  q.t,   q.n.x, q.n.y, q.n.z },
-		{ q.p2.x, q.p2.y, q.p2.z,   q.w,  q.h, (GLfloat)  q.t,   q.n.x, q.n.y, q.n.z },
-		{ q.p3.x, q.p3.y, q.p3.z,   0.0,  q.h, (GLfloat)  q.t,   q.n.x, q.n.y, q.n.z }
-	};
-	GLuint offset = (GLuint) v->size();
-	GLuint i_a[5] = FACE_INDICES;
-		
-	v->insert( v->end(), v_face, v_face + 4 );
-	i->insert( i->end(), i_a,    i_a    + 5 );
-}
-
-
 /*!
  * Returns a pointer to a torus mesh with given dimensions.
  */
@@ -65,14 +65,14 @@ protected:
 
 public:
 	Mesh(
-		std::vector<vertex> vertices,
-		std::vector<GLuint> indices,
+		const std::vector<vertex>& vertices,
+		const std::vector<GLuint>& indices,
 		GLenum poly_mode
 	);
 
 	void rebuffer(
-		std::vector<vertex> vertices,
-		std::vector<GLuint> indices,
+		const std::vector<vertex>& vertices,
+		const std::vector<GLuint>& indices,
 		GLenum poly_mode
 	);
 
@@ -137,8 +137,8 @@ private:
 
 public:
 	LerpMesh(
-		std::vector<vertex> vertices,
-		std::vector<GLuint> indices,
+		const std::vector<vertex>& vertices,
+		const std::vector<GLuint>& indices,
 		GLenum poly_mode
 	);
 
@@ -154,3 +154,24 @@ public:
 	void addScale( glm::vec3 factor );
 	void rotate( float amount );
 };
+
+
+/*!
+ * Appends the vertices and indices of a single given 2d quad to a 3d mesh,
+ * using an up vector. Inline, and free of GL calls, as the terrain mesher
+ * calls it for every quad on any thread.
+ */
+inline void Mesh::appendQuad( quad q, std::vector<vertex>* v, std::vector<GLuint>* i )
+{
+	vertex v_face[4] = {
+		{ q.p0.x, q.p0.y, q.p0.z,   0.0,  0.0, (GLfloat)  q.t,   q.n.x, q.n.y, q.n.z },
+		{ q.p1.x, q.p1.y, q.p1.z,   q.w,  0.0, (GLfloat)  q.t,   q.n.x, q.n.y, q.n.z },
+		{ q.p2.x, q.p2.y, q.p2.z,   q.w,  q.h, (GLfloat)  q.t,   q.n.x, q.n.y, q.n.z },
+		{ q.p3.x, q.p3.y, q.p3.z,   0.0,  q.h, (GLfloat)  q.t,   q.n.x, q.n.y, q.n.z }
+	};
+	GLuint offset = (GLuint) v->size();
+	GLuint i_a[5] = { offset, offset + 1, offset + 2, offset + 3, 0xffffffff };
+
+	v->insert( v->end(), v_face, v_face + 4 );
+	i->insert( i->end(), i_a,    i_a    + 5 );
+}
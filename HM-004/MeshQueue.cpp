@@ -0,0 +1,122 @@
+#include "Base.h"
+#include "MeshQueue.h"
+
+#include "Chunk.h"
+#include "TerrainMesh.h"
+
+
+/*!
+ * Starts the given number of meshing threads, or one per hardware thread if
+ * zero.
+ */
+MeshQueue::MeshQueue( int threads ) :
+	pool( threads ),
+	pending( 0 ),
+	cancelled( false )
+{
+}
+
+
+/*!
+ * Cancels any chunks not yet meshed and frees every buffer.
+ */
+MeshQueue::~MeshQueue( void )
+{
+	cancel();
+
+	for ( auto& r : finished )
+		delete r.data;
+	for ( auto d : spare )
+		delete d;
+}
+
+
+/*!
+ * Queues a chunk to be meshed on the next free worker.
+ */
+void MeshQueue::submit( Chunk* chunk )
+{
+	pending++;
+
+	pool.submit( [this, chunk]
+	{
+		if ( cancelled )
+		{
+			pending--;
+			return;
+		}
+
+		MeshData* data = nullptr;
+		{
+			std::lock_guard<std::mutex> lock( mutex );
+			if ( !spare.empty() )
+			{
+				data = spare.back();
+				spare.pop_back();
+			}
+		}
+
+		if ( !data )
+			data = new MeshData();
+
+		chunk->buildMesh( data );
+
+		std::lock_guard<std::mutex> lock( mutex );
+		Result r = { chunk, data };
+		finished.push_back( r );
+	} );
+}
+
+
+/*!
+ * Takes the oldest meshed chunk, returning false if none are ready. Its
+ * mesh, which has no vertices if the chunk has no visible faces, should be
+ * given back to recycle() once uploaded.
+ */
+bool MeshQueue::pop( Chunk** chunk, MeshData** data )
+{
+	std::lock_guard<std::mutex> lock( mutex );
+
+	if ( finished.empty() )
+		return false;
+
+	*chunk = finished.front().chunk;
+	*data  = finished.front().data;
+	finished.pop_front();
+	pending--;
+
+	return true;
+}
+
+
+/*!
+ * Returns a popped mesh's buffers for reuse.
+ */
+void MeshQueue::recycle( MeshData* data )
+{
+	std::lock_guard<std::mutex> lock( mutex );
+
+	spare.push_back( data );
+}
+
+
+/*!
+ * Skips every chunk not yet started and waits for those in progress, after
+ * which the terrain may be edited or deleted. Meshes already finished can
+ * still be popped.
+ */
+void MeshQueue::cancel( void )
+{
+	cancelled = true;
+	pool.wait();
+	cancelled = false;
+}
+
+
+/*!
+ * Returns the number of chunks submitted but not yet popped.
+ */
+int MeshQueue::getPending( void ) const
+{
+	return pending;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+
+#include "MacroTerrain.h"
+#include "ThreadPool.h"
+
+
+class Chunk;
+
+struct MeshData;
+
+
+/*!
+ * Meshes chunks on a pool of worker threads, collecting the CPU-side meshes
+ * for the main thread to upload as it has time. MeshData buffers are handed
+ * back once uploaded and reused for later chunks, so steady remeshing
+ * allocates nothing.
+ *
+ * Chunks are read while they are meshed, so nothing may edit the terrain
+ * while any are pending.
+ */
+class MeshQueue {
+private:
+	struct Result {
+		Chunk*    chunk;
+		MeshData* data;
+	};
+
+	ThreadPool pool;
+
+	std::mutex mutex;
+	std::deque<Result>     finished;
+	std::vector<MeshData*> spare;
+
+	std::atomic<int>  pending;
+	std::atomic<bool> cancelled;
+
+public:
+	MeshQueue( int threads = TRN_MESH_THREADS );
+	~MeshQueue( void );
+
+	void submit( Chunk* chunk );
+	bool pop( Chunk** chunk, MeshData** data );
+	void recycle( MeshData* data );
+	void cancel( void );
+
+	int getPending( void ) const;
+};
@@ -0,0 +1,356 @@
+#include "Base.h"
+#include "Mesher.h"
+
+#include "ChunkSnapshot.h"
+#include "MesherWorkspace.h"
+#include "Terrain.h"
+#include "TerrainMesh.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+
+MesherType Mesher::type = MESHER_BINARY;
+
+
+/*!
+ * Returns the index of the lowest set bit of a non-zero word.
+ */
+static inline int lowestBit( unsigned long long x )
+{
+#if defined( _MSC_VER ) && defined( _WIN64 )
+	unsigned long i;
+	_BitScanForward64( &i, x );
+	return (int) i;
+#elif defined( _MSC_VER )
+	unsigned long i;
+	if ( _BitScanForward( &i, (unsigned long) x ) )
+		return (int) i;
+	_BitScanForward( &i, (unsigned long) ( x >> 32 ) );
+	return (int) i + 32;
+#else
+	return __builtin_ctzll( x );
+#endif
+}
+
+
+/*!
+ * Selects the mesher used by generate().
+ */
+void Mesher::setType( MesherType type )
+{
+	Mesher::type = type;
+}
+
+
+/*!
+ * Returns the mesher used by generate().
+ */
+MesherType Mesher::getType( void )
+{
+	return type;
+}
+
+
+/*!
+ * Meshes a snapshot with the currently selected mesher, appending to the
+ * given vectors.
+ */
+void Mesher::generate(
+	const ChunkSnapshot& snapshot,
+	const BlockType* types,
+	std::vector<TerrainVertex>* vertices,
+	std::vector<GLuint>* indices
+)
+{
+	if ( type == MESHER_BINARY )
+		binary( snapshot, types, vertices, indices );
+	else
+		greedy( snapshot, types, vertices, indices );
+}
+
+
+/*!
+ * Returns a bit for each face of the chunk, in normal order (+x, -x, +y, -y,
+ * +z, -z), set if the layer of blocks against it is entirely solid. Such a
+ * face hides everything behind it, and so serves as an occluder.
+ */
+unsigned char Mesher::findSolidFaces( const ChunkSnapshot& snapshot )
+{
+	int size = snapshot.getSize();
+	unsigned char faces = 0;
+
+	for ( int d = 0; d < 3; d++ )
+	{
+		int u = ( d == 0 ) ? 2 : 0;
+		int v = ( d == 1 ) ? 2 : 1;
+
+		for ( int side = 0; side < 2; side++ )
+		{
+			glm::ivec3 p;
+			p[d] = side ? 0 : size - 1;
+
+			bool solid = true;
+			for ( p[u] = 0; solid && p[u] < size; p[u]++ )
+			for ( p[v] = 0; solid && p[v] < size; p[v]++ )
+				solid = snapshot.get( p ) != 0;
+
+			if ( solid )
+				faces |= 1 << ( d * 2 + side );
+		}
+	}
+
+	return faces;
+}
+
+
+/*!
+ * Appends one merged quad of w by h faces, whose first face lies at (i, j)
+ * on the given slice along axis d. f is true if the block behind the slice
+ * is the solid one.
+ */
+void Mesher::emitQuad(
+	int d, int slice,
+	int i, int j,
+	int w, int h,
+	char t, bool f,
+	const BlockType* types,
+	std::vector<TerrainVertex>* vertices,
+	std::vector<GLuint>* indices
+)
+{
+	glm::ivec3 p;
+	int u = ( d == 0 ) ? 2 : 0;
+	int v = ( d == 1 ) ? 2 : 1;
+
+	p[d] = slice;
+
+	// Flip faces on x and y axes because reasons.
+	if ( d != 2 )
+		f = !f;
+
+	p[u] = f ? i : i + w;
+	p[v] = j;
+	glm::ivec3 wd; wd[u] = f ? w : -w;
+	glm::ivec3 hd; hd[v] = h;
+
+	glm::ivec3 corners[4] = { p, p + wd, p + wd + hd, p + hd };
+	int texture = types[(unsigned char) t].textures[d + (int) f];
+	TerrainMesh::appendQuad( corners, d * 2 + ( f ? 0 : 1 ), w, h, texture, vertices, indices );
+}
+
+
+/*!
+ * Greedy mesher working on byte masks. Each slice is scanned row by row, and
+ * each unvisited face is grown as wide and then as tall as it can go.
+ */
+void Mesher::greedy(
+	const ChunkSnapshot& snapshot,
+	const BlockType* types,
+	std::vector<TerrainVertex>* vertices,
+	std::vector<GLuint>* indices
+)
+{
+	int size = snapshot.getSize();
+
+	// Uniform chunks can only have faces on their outer slices.
+	int step = snapshot.isUniform() ? size : 1;
+
+	// Slice masks, indexed [i * size + j].
+	MesherWorkspace* workspace = MesherWorkspace::local();
+	workspace->prepare( size );
+	char* type = &workspace->type[0];
+	char* face = &workspace->face[0];
+
+	for ( int d = 0; d < 3; d++ )
+	{
+		glm::ivec3 p, q;
+		int u = ( d == 0 ) ? 2 : 0;
+		int v = ( d == 1 ) ? 2 : 1;
+		q[d] = 1;
+
+		// Perform algorithm on set of 2D slices along axis d.
+		for ( p[d] = 0; p[d] <= size; p[d] += step )
+		{
+			// Compute mask for slice.
+			for ( p[u] = 0; p[u] < size; p[u]++ )
+			for ( p[v] = 0; p[v] < size; p[v]++ )
+			{
+				char near = snapshot.get( p - q );
+				char far  = snapshot.get( p );
+				type[p[u] * size + p[v]] = ( near != 0 ) ^ ( far != 0 ) ? near | far : 0;
+				face[p[u] * size + p[v]] = ( near != 0 );
+			}
+
+			// Generate mesh for slice lexicographically.
+			for ( int j = 0; j < size; j++ )
+			for ( int i = 0; i < size; )
+			{
+				char t = type[i * size + j];
+				if ( t > 0 )
+				{
+					// Whether the quad faces backwards along the axis.
+					bool f = face[i * size + j] != 0;
+
+					// Compute width and height of quad.
+					int w, h = size;
+					for ( w = 0; i + w < size && type[( i + w ) * size + j] == t && face[( i + w ) * size + j] == f; w++ )
+					{
+						int th;
+						for ( th = 1; j + th < size && type[( i + w ) * size + j + th] == t && face[( i + w ) * size + j + th] == f; th++ );
+						if ( h > th )
+							h = th;
+					}
+
+					emitQuad( d, p[d], i, j, w, h, t, f, types, vertices, indices );
+
+					// Mark this area clear on mask.
+					for ( int l = i; l < i + w; l++ )
+					for ( int k = j; k < j + h; k++ )
+						type[l * size + k] = 0;
+
+					// Advance along by width of quad.
+					i += w;
+				} else
+					// Advance along by one.
+					i++;
+			}
+		}
+	}
+}
+
+
+/*!
+ * Greedy mesher working on bit masks. Solid blocks along each column of the
+ * axis are packed into a word, so a shift and an xor find every face in the
+ * column at once. Faces are then sorted into one row mask per block id and
+ * facing, and quads are found by scanning set bits: the width is a run of
+ * ones and each row of height is a single mask test. Quads come out in the
+ * same order and shape as greedy(), so the meshes are identical.
+ *
+ * Columns hold size + 2 bits, so chunks over 62 blocks fall back to greedy().
+ */
+void Mesher::binary(
+	const ChunkSnapshot& snapshot,
+	const BlockType* types,
+	std::vector<TerrainVertex>* vertices,
+	std::vector<GLuint>* indices
+)
+{
+	int size = snapshot.getSize();
+	if ( size > 62 )
+	{
+		greedy( snapshot, types, vertices, indices );
+		return;
+	}
+
+	int slices = size + 1;
+	unsigned long long faceMask = ( 1ULL << slices ) - 1;
+
+	// Row masks, indexed [material][slice][v], with one bit per u. A material
+	// is a block id plus facing, numbered in order of first appearance. They
+	// live in the workspace, so their capacity carries over between chunks.
+	MesherWorkspace* workspace = MesherWorkspace::local();
+	workspace->prepare( size );
+	std::vector<unsigned long long>& masks = workspace->masks;
+	std::vector<int>& materials = workspace->materials;
+	std::vector<unsigned long long>& any = workspace->any;
+	int slot[256];
+
+	for ( int d = 0; d < 3; d++ )
+	{
+		int u = ( d == 0 ) ? 2 : 0;
+		int v = ( d == 1 ) ? 2 : 1;
+
+		masks.clear();
+		materials.clear();
+		memset( slot, -1, sizeof ( slot ) );
+
+		// Find faces a column at a time, and scatter them into the row masks.
+		glm::ivec3 p;
+		for ( p[u] = 0; p[u] < size; p[u]++ )
+		for ( p[v] = 0; p[v] < size; p[v]++ )
+		{
+			// Bit n holds the block at n - 1 along the axis.
+			unsigned long long column = 0;
+			for ( p[d] = -1; p[d] <= size; p[d]++ )
+				if ( snapshot.get( p ) != 0 )
+					column |= 1ULL << ( p[d] + 1 );
+
+			// Bit n is set where the blocks at n - 1 and n differ.
+			unsigned long long faces = ( column ^ ( column >> 1 ) ) & faceMask;
+			while ( faces )
+			{
+				int s = lowestBit( faces );
+				faces &= faces - 1;
+
+				bool f = ( column >> s ) & 1;
+				p[d] = f ? s - 1 : s;
+				char t = snapshot.get( p );
+				if ( t <= 0 )
+					continue;
+
+				int key = ( t << 1 ) | (int) f;
+				if ( slot[key] < 0 )
+				{
+					slot[key] = (int) materials.size();
+					materials.push_back( key );
+					masks.resize( masks.size() + slices * size, 0 );
+				}
+
+				masks[( slot[key] * slices + s ) * size + p[v]] |= 1ULL << p[u];
+			}
+		}
+
+		int count = (int) materials.size();
+		if ( !count )
+			continue;
+
+		// Generate mesh for each slice lexicographically.
+		for ( int s = 0; s < slices; s++ )
+		{
+			for ( int j = 0; j < size; j++ )
+			{
+				any[j] = 0;
+				for ( int m = 0; m < count; m++ )
+					any[j] |= masks[( m * slices + s ) * size + j];
+			}
+
+			for ( int j = 0; j < size; j++ )
+			while ( any[j] )
+			{
+				int i = lowestBit( any[j] );
+
+				// Only one material can own a given face.
+				unsigned long long* rows = nullptr;
+				int m;
+				for ( m = 0; m < count; m++ )
+				{
+					rows = &masks[( m * slices + s ) * size];
+					if ( ( rows[j] >> i ) & 1 )
+						break;
+				}
+
+				// Width is the run of ones from i, height the number of rows
+				// that hold the whole run.
+				unsigned long long run = rows[j] >> i;
+				int w = lowestBit( ~run );
+				unsigned long long wmask = ( ( 1ULL << w ) - 1 ) << i;
+
+				int h;
+				for ( h = 1; j + h < size && ( rows[j+h] & wmask ) == wmask; h++ );
+
+				for ( int k = j; k < j + h; k++ )
+				{
+					rows[k] &= ~wmask;
+					any[k]  &= ~wmask;
+				}
+
+				char t = (char) ( materials[m] >> 1 );
+				bool f = ( materials[m] & 1 ) != 0;
+				emitQuad( d, s, i, j, w, h, t, f, types, vertices, indices );
+			}
+		}
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+
+struct BlockType;
+struct TerrainVertex;
+
+class ChunkSnapshot;
+
+
+enum MesherType {
+	MESHER_GREEDY = 0,
+	MESHER_BINARY
+};
+
+
+/*!
+ * Builds chunk geometry from a ChunkSnapshot, in packed vertices local to the
+ * chunk. Both meshers merge faces into the same quads, emitted in the same
+ * order, so their output is identical; the binary mesher just finds and
+ * extends them with bit operations on packed rows instead of scanning byte
+ * masks.
+ */
+class Mesher {
+private:
+	static MesherType type;
+
+	static void emitQuad(
+		int d, int slice,
+		int i, int j,
+		int w, int h,
+		char t, bool f,
+		const BlockType* types,
+		std::vector<TerrainVertex>* vertices,
+		std::vector<GLuint>* indices
+	);
+
+public:
+	static void       setType( MesherType type );
+	static MesherType getType( void );
+
+	static unsigned char findSolidFaces( const ChunkSnapshot& snapshot );
+
+	static void generate(
+		const ChunkSnapshot& snapshot,
+		const BlockType* types,
+		std::vector<TerrainVertex>* vertices,
+		std::vector<GLuint>* indices
+	);
+
+	static void greedy(
+		const ChunkSnapshot& snapshot,
+		const BlockType* types,
+		std::vector<TerrainVertex>* vertices,
+		std::vector<GLuint>* indices
+	);
+
+	static void binary(
+		const ChunkSnapshot& snapshot,
+		const BlockType* types,
+		std::vector<TerrainVertex>* vertices,
+		std::vector<GLuint>* indices
+	);
+};
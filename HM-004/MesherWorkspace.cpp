@@ -0,0 +1,72 @@
+#include "Base.h"
+#include "MesherWorkspace.h"
+
+#include <memory>
+#include <mutex>
+
+#ifdef _MSC_VER
+#define MW_THREAD __declspec( thread )
+#else
+#define MW_THREAD __thread
+#endif
+
+
+// This thread's workspace, if it has meshed anything yet.
+static MW_THREAD MesherWorkspace* current = nullptr;
+
+// Every workspace made, freed at exit.
+static std::mutex registryMutex;
+static std::vector<std::unique_ptr<MesherWorkspace>> registry;
+
+
+MesherWorkspace::MesherWorkspace( void ) :
+	snapshot( 0 ),
+	vertexHint( 0 ),
+	indexHint( 0 )
+{
+}
+
+
+/*!
+ * Sizes the buffers for chunks of the given size. Does nothing if they
+ * already fit.
+ */
+void MesherWorkspace::prepare( int size )
+{
+	if ( snapshot.getSize() == size )
+		return;
+
+	snapshot = ChunkSnapshot( size );
+	type.assign( size * size, 0 );
+	face.assign( size * size, 0 );
+	any.assign( size, 0 );
+}
+
+
+/*!
+ * Returns the calling thread's workspace, creating it on first use.
+ */
+MesherWorkspace* MesherWorkspace::local( void )
+{
+	if ( !current )
+	{
+		current = new MesherWorkspace();
+
+		std::lock_guard<std::mutex> lock( registryMutex );
+		registry.push_back( std::unique_ptr<MesherWorkspace>( current ) );
+	}
+
+	return current;
+}
+
+
+/*!
+ * Returns the number of workspaces made so far, one per thread that has
+ * meshed.
+ */
+int MesherWorkspace::getCount( void )
+{
+	std::lock_guard<std::mutex> lock( registryMutex );
+
+	return (int) registry.size();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+
+#include "ChunkSnapshot.h"
+#include "TerrainMesh.h"
+
+
+/*!
+ * Scratch memory for meshing chunks on one thread: the snapshot, the
+ * meshers' masks, and a staging MeshData callers may build into. Everything
+ * is cleared rather than freed between chunks, so once a thread has meshed a
+ * chunk as complex as any it meets later, meshing allocates nothing.
+ *
+ * Each thread gets its own workspace on first use, which lasts until the
+ * process exits, so meshing is best done on long-lived threads.
+ */
+struct MesherWorkspace {
+	ChunkSnapshot snapshot;
+
+	// Greedy mesher: block id and facing of each face in a slice, [i][j].
+	std::vector<char> type;
+	std::vector<char> face;
+
+	// Binary mesher: row masks per material, the materials, and the union
+	// of every material's rows in a slice.
+	std::vector<unsigned long long> masks;
+	std::vector<int>                materials;
+	std::vector<unsigned long long> any;
+
+	// Staging for built meshes, and the most vertices and indices any mesh
+	// built here has needed, which fresh output is reserved to.
+	MeshData mesh;
+	size_t   vertexHint;
+	size_t   indexHint;
+
+	MesherWorkspace( void );
+
+	void prepare( int size );
+
+	static MesherWorkspace* local( void );
+	static int              getCount( void );
+};
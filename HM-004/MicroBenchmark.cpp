@@ -0,0 +1,950 @@
+#include "MacroWindow.h"
+
+#include "Base.h"
+#include "MicroBenchmark.h"
+
+#include "Chunk.h"
+#include "ChunkSnapshot.h"
+#include "Clock.h"
+#include "ColumnData.h"
+#include "Frustum.h"
+#include "GenStages.h"
+#include "Mesher.h"
+#include "Noise.h"
+#include "OcclusionCuller.h"
+#include "RenderQueue.h"
+#include "Terrain.h"
+#include "TerrainMesh.h"
+#include "ThreadPool.h"
+
+
+// Each benchmark repeats its pass until at least this many seconds have run.
+#define MB_MIN_TIME 0.25
+
+// Positions per block lookup pass.
+#define MB_LOOKUPS 65536
+
+
+std::vector<MicroBenchmark::Result> MicroBenchmark::results;
+unsigned long long MicroBenchmark::sink = 0;
+
+
+// Heap allocations made through new on any thread, for measure() to report
+// per operation. New is only replaced in this mode, so other builds keep the
+// default allocator and always count zero.
+static std::atomic<unsigned long long> allocations( 0 );
+
+
+#ifdef MICROBENCH_MODE
+
+void* operator new( size_t bytes )
+{
+	allocations++;
+
+	void* p = malloc( bytes ? bytes : 1 );
+	if ( !p )
+		throw std::bad_alloc();
+
+	return p;
+}
+
+
+void* operator new[]( size_t bytes )
+{
+	return operator new( bytes );
+}
+
+
+void operator delete( void* p )
+{
+	free( p );
+}
+
+
+void operator delete[]( void* p )
+{
+	free( p );
+}
+#endif
+
+
+/*!
+ * Runs every benchmark on every fixture it applies to, then writes the
+ * results out.
+ */
+void MicroBenchmark::run( void )
+{
+	results.clear();
+
+	for ( int f = 0; f < FIXTURE_COUNT; f++ )
+	{
+		std::cout << "Fixture " << getFixtureName( f ) << "...\n";
+
+		std::vector<Chunk*> targets;
+		Terrain* terrain = createFixture( f, &targets );
+
+		chunkLookup( f, targets );
+		terrainLookup( f, terrain, targets );
+		storage( f, targets );
+		meshing( f, targets );
+		meshers( f, terrain, targets );
+
+		delete terrain;
+	}
+
+	quads();
+	culling();
+	noise();
+	caves();
+	generation();
+
+	write( "microbenchmark.json" );
+
+	std::cout << "Wrote " << results.size() << " results to microbenchmark.json (checksum " << sink << ")\n";
+}
+
+
+const char* MicroBenchmark::getFixtureName( int fixture )
+{
+	const char* names[FIXTURE_COUNT] = { "empty", "full", "checkerboard", "noise", "island" };
+
+	return names[fixture];
+}
+
+
+/*!
+ * Builds the terrain for a fixture and picks the chunks to measure. The
+ * island is the default generated world, measured over every chunk that is
+ * not all air. The synthetic fixtures fill a 3x3x3 world with one pattern and
+ * measure the middle chunk, so every border it reads has a real neighbour.
+ * Patterns are laid out in world space, so they carry on across borders.
+ */
+Terrain* MicroBenchmark::createFixture( int fixture, std::vector<Chunk*>* targets )
+{
+	if ( fixture == FIXTURE_ISLAND )
+	{
+		Terrain* terrain = new Terrain( WorldGenParams(), 0 );
+		for ( auto& c : terrain->getChunks() )
+			if ( !c.chunk->isUniform() || c.chunk->getBlockAt( 0, 0, 0 ).id != 0 )
+				targets->push_back( c.chunk );
+
+		return terrain;
+	}
+
+	WorldGenParams params;
+	params.width = params.height = params.depth = 3;
+	Terrain* terrain = new Terrain( params, 1 );
+
+	const int size = TRN_CHUNK_SIZE;
+	std::vector<Block> blocks( size * size * size );
+	unsigned int seed = 12345;
+
+	for ( auto& c : terrain->getChunks() )
+	{
+		glm::ivec3 origin = c.position * size;
+
+		int i = 0;
+		for ( int x = 0; x < size; x++ )
+		for ( int y = 0; y < size; y++ )
+		for ( int z = 0; z < size; z++, i++ )
+		{
+			switch ( fixture )
+			{
+			case FIXTURE_EMPTY:
+				blocks[i].id = 0;
+				break;
+			case FIXTURE_FULL:
+				blocks[i].id = 3;
+				break;
+			case FIXTURE_CHECKERBOARD:
+				blocks[i].id = ( ( origin.x + x + origin.y + y + origin.z + z ) & 1 ) ? 3 : 0;
+				break;
+			default:
+				seed = seed * 1664525 + 1013904223;
+				blocks[i].id = (char) ( ( seed >> 16 ) % 4 );
+			}
+		}
+
+		c.chunk->load( &blocks[0] );
+	}
+
+	targets->push_back( terrain->getChunkAt( glm::ivec3( 1, 1, 1 ) ) );
+
+	return terrain;
+}
+
+
+/*!
+ * Times a pass, repeating it until MB_MIN_TIME has run, and records the
+ * result along with the heap allocations it made. The pass returns the
+ * number of operations it performed and adds any quads it produced to its
+ * argument. One untimed pass runs first, so buffers that are reused from
+ * one pass to the next have grown before anything is counted.
+ */
+void MicroBenchmark::measure( std::string name, int fixture, double voxelsPerOp, std::function<double( double* quads )> pass )
+{
+	double ops = 0.0, quads = 0.0, elapsed = 0.0;
+
+	pass( &quads );
+	quads = 0.0;
+
+	unsigned long long allocated = allocations;
+	do
+	{
+		double start = Clock::now();
+		ops += pass( &quads );
+		elapsed += Clock::now() - start;
+	} while ( elapsed < MB_MIN_TIME );
+	allocated = allocations - allocated;
+
+	Result r = {
+		name,
+		fixture < 0 ? "" : getFixtureName( fixture ),
+		ops,
+		elapsed,
+		voxelsPerOp,
+		quads / ops,
+		allocated / ops,
+		0.0
+	};
+	results.push_back( r );
+
+	std::cout << std::fixed << std::setprecision( 2 )
+	          << "  " << std::left << std::setw( 32 ) << name << std::right
+	          << std::setw( 12 ) << elapsed / ops * 1e9 << " ns/op"
+	          << std::setw( 10 ) << r.allocsPerOp << " allocs/op\n";
+}
+
+
+/*!
+ * Chunk::getBlockAt, in storage scan order and at scattered positions.
+ */
+void MicroBenchmark::chunkLookup( int fixture, const std::vector<Chunk*>& targets )
+{
+	const int size = TRN_CHUNK_SIZE;
+
+	measure( "chunk.getBlockAt.sequential", fixture, 1.0, [&]( double* )
+	{
+		unsigned long long sum = 0;
+		for ( auto c : targets )
+			for ( int x = 0; x < size; x++ )
+			for ( int y = 0; y < size; y++ )
+			for ( int z = 0; z < size; z++ )
+				sum += c->getBlockAt( x, y, z ).id;
+
+		sink += sum;
+		return (double) targets.size() * size * size * size;
+	} );
+
+	std::vector<glm::ivec3> positions( MB_LOOKUPS );
+	unsigned int seed = 12345;
+	for ( auto& p : positions )
+	{
+		seed = seed * 1664525 + 1013904223;
+		p = glm::ivec3( ( seed >> 4 ) % size, ( seed >> 12 ) % size, ( seed >> 20 ) % size );
+	}
+
+	measure( "chunk.getBlockAt.random", fixture, 1.0, [&]( double* )
+	{
+		unsigned long long sum = 0;
+		int n = 0;
+		for ( auto& p : positions )
+			sum += targets[n++ % targets.size()]->getBlockAt( p ).id;
+
+		sink += sum;
+		return (double) positions.size();
+	} );
+}
+
+
+/*!
+ * Terrain::getBlockAt, at scattered positions inside the measured chunks, and
+ * at positions one block outside their faces, as the mesher reads borders.
+ */
+void MicroBenchmark::terrainLookup( int fixture, Terrain* terrain, const std::vector<Chunk*>& targets )
+{
+	const int size = TRN_CHUNK_SIZE;
+
+	std::vector<glm::ivec3> interior( MB_LOOKUPS ), border( MB_LOOKUPS );
+	unsigned int seed = 12345;
+	for ( int n = 0; n < MB_LOOKUPS; n++ )
+	{
+		glm::ivec3 origin = targets[n % targets.size()]->getPosition() * size;
+
+		seed = seed * 1664525 + 1013904223;
+		interior[n] = origin + glm::ivec3( 1 + ( seed >> 4 ) % ( size - 2 ), 1 + ( seed >> 12 ) % ( size - 2 ), 1 + ( seed >> 20 ) % ( size - 2 ) );
+
+		// A random position on a random face, pushed one block outwards.
+		glm::ivec3 p( ( seed >> 4 ) % size, ( seed >> 12 ) % size, ( seed >> 20 ) % size );
+		int axis = ( seed >> 28 ) % 3;
+		p[axis] = ( seed >> 30 ) & 1 ? size : -1;
+		border[n] = origin + p;
+	}
+
+	measure( "terrain.getBlockAt.interior", fixture, 1.0, [&]( double* )
+	{
+		unsigned long long sum = 0;
+		for ( auto& p : interior )
+			sum += terrain->getBlockAt( p ).id;
+
+		sink += sum;
+		return (double) interior.size();
+	} );
+
+	measure( "terrain.getBlockAt.border", fixture, 1.0, [&]( double* )
+	{
+		unsigned long long sum = 0;
+		for ( auto& p : border )
+			sum += terrain->getBlockAt( p ).id;
+
+		sink += sum;
+		return (double) border.size();
+	} );
+}
+
+
+/*!
+ * FlatStorage and PaletteStorage holding copies of the measured chunks, both
+ * compacted, for the bulk decode the mesher performs and for scattered
+ * reads. Each record also gives the storage's bytes per chunk, in which
+ * uniform chunks, needing no voxel array, count for almost nothing.
+ */
+void MicroBenchmark::storage( int fixture, const std::vector<Chunk*>& targets )
+{
+	const int count = TRN_CHUNK_SIZE * TRN_CHUNK_SIZE * TRN_CHUNK_SIZE;
+
+	std::vector<FlatStorage*>    flat;
+	std::vector<PaletteStorage*> packed;
+	std::vector<Block> blocks( count );
+	double flatBytes = 0.0, packedBytes = 0.0;
+	int bits[9] = { 0 };
+
+	for ( auto c : targets )
+	{
+		c->unpack( &blocks[0] );
+
+		FlatStorage*    f = new FlatStorage( count );
+		PaletteStorage* p = new PaletteStorage( count );
+		for ( int i = 0; i < count; i++ )
+		{
+			f->set( i, blocks[i] );
+			p->set( i, blocks[i] );
+		}
+		f->compact();
+		p->compact();
+
+		flatBytes   += f->getMemoryUsage();
+		packedBytes += p->getMemoryUsage();
+		bits[p->getBits()]++;
+
+		flat.push_back( f );
+		packed.push_back( p );
+	}
+
+	int chunks = (int) targets.size();
+
+	std::vector<int> positions( MB_LOOKUPS );
+	unsigned int seed = 12345;
+	for ( auto& i : positions )
+	{
+		seed = seed * 1664525 + 1013904223;
+		i = ( seed >> 4 ) % count;
+	}
+
+	measure( "storage.flat.unpack", fixture, (double) count, [&]( double* )
+	{
+		for ( auto f : flat )
+			f->unpack( &blocks[0] );
+
+		sink += blocks[count / 2].id;
+		return (double) chunks;
+	} );
+	results.back().bytesPerChunk = flatBytes / chunks;
+
+	measure( "storage.palette.unpack", fixture, (double) count, [&]( double* )
+	{
+		for ( auto p : packed )
+			p->unpack( &blocks[0] );
+
+		sink += blocks[count / 2].id;
+		return (double) chunks;
+	} );
+	results.back().bytesPerChunk = packedBytes / chunks;
+
+	measure( "storage.flat.get.random", fixture, 1.0, [&]( double* )
+	{
+		unsigned long long sum = 0;
+		int n = 0;
+		for ( int i : positions )
+			sum += flat[n++ % chunks]->get( i ).id;
+
+		sink += sum;
+		return (double) positions.size();
+	} );
+	results.back().bytesPerChunk = flatBytes / chunks;
+
+	measure( "storage.palette.get.random", fixture, 1.0, [&]( double* )
+	{
+		unsigned long long sum = 0;
+		int n = 0;
+		for ( int i : positions )
+			sum += packed[n++ % chunks]->get( i ).id;
+
+		sink += sum;
+		return (double) positions.size();
+	} );
+	results.back().bytesPerChunk = packedBytes / chunks;
+
+	std::cout << std::fixed << std::setprecision( 2 )
+	          << "  Palette storage " << packedBytes / chunks << " bytes per chunk, flat " << flatBytes / chunks
+	          << "; chunks at 0/1/2/4/8 bits: "
+	          << bits[0] << "/" << bits[1] << "/" << bits[2] << "/" << bits[4] << "/" << bits[8] << "\n";
+
+	for ( int c = 0; c < chunks; c++ )
+	{
+		delete flat[c];
+		delete packed[c];
+	}
+}
+
+
+/*!
+ * Chunk::buildMesh, which snapshots the chunk and its border and runs the
+ * selected mesher, per chunk. Output goes to one reused MeshData, as when
+ * remeshing, so allocs/op should be zero.
+ */
+void MicroBenchmark::meshing( int fixture, const std::vector<Chunk*>& targets )
+{
+	const int size = TRN_CHUNK_SIZE;
+	MeshData data;
+
+	measure( "chunk.buildMesh", fixture, (double) size * size * size, [&]( double* quads )
+	{
+		for ( auto c : targets )
+		{
+			c->buildMesh( &data );
+			*quads += data.vertices.size() / 4;
+		}
+
+		return (double) targets.size();
+	} );
+}
+
+
+/*!
+ * Mesher::greedy and Mesher::binary on snapshots of the measured chunks,
+ * taken once, so only the meshing itself is timed. Also checks that the two
+ * build identical meshes.
+ */
+void MicroBenchmark::meshers( int fixture, Terrain* terrain, const std::vector<Chunk*>& targets )
+{
+	const int size = TRN_CHUNK_SIZE;
+	const BlockType* types = terrain->getBlockTypes();
+
+	std::vector<ChunkSnapshot*> snapshots;
+	for ( auto c : targets )
+	{
+		ChunkSnapshot* s = new ChunkSnapshot( size );
+		s->capture( c, terrain );
+		snapshots.push_back( s );
+	}
+
+	std::vector<TerrainVertex> vertices[2];
+	std::vector<GLuint> indices[2];
+	auto build = [&]( int m, const ChunkSnapshot& s )
+	{
+		vertices[m].clear();
+		indices[m].clear();
+
+		if ( m == 0 )
+			Mesher::greedy( s, types, &vertices[m], &indices[m] );
+		else
+			Mesher::binary( s, types, &vertices[m], &indices[m] );
+	};
+
+	bool identical = true;
+	for ( auto s : snapshots )
+	{
+		build( 0, *s );
+		build( 1, *s );
+		identical = identical
+			&& vertices[0].size() == vertices[1].size()
+			&& indices[0] == indices[1]
+			&& ( vertices[0].empty() || !memcmp( &vertices[0][0], &vertices[1][0], sizeof ( TerrainVertex ) * vertices[0].size() ) );
+	}
+
+	std::cout << "  Greedy and binary meshes " << ( identical ? "match" : "MISMATCH" ) << "\n";
+
+	const char* names[2] = { "mesher.greedy", "mesher.binary" };
+	for ( int m = 0; m < 2; m++ )
+	{
+		measure( names[m], fixture, (double) size * size * size, [&]( double* quads )
+		{
+			for ( auto s : snapshots )
+			{
+				build( m, *s );
+				*quads += vertices[m].size() / 4;
+			}
+
+			return (double) snapshots.size();
+		} );
+	}
+
+	for ( auto s : snapshots )
+		delete s;
+}
+
+
+/*!
+ * TerrainMesh::appendQuad into vectors that have already grown to size, as
+ * when meshing one chunk after another with the same buffers.
+ */
+void MicroBenchmark::quads( void )
+{
+	const int count = 4096;
+
+	std::vector<TerrainVertex> vertices;
+	std::vector<GLuint> indices;
+	vertices.reserve( count * 4 );
+	indices.reserve( count * 5 );
+
+	measure( "mesh.appendQuad", -1, 0.0, [&]( double* quads )
+	{
+		vertices.clear();
+		indices.clear();
+
+		for ( int n = 0; n < count; n++ )
+		{
+			glm::ivec3 p( n & 15, n >> 4 & 15, n >> 8 );
+			glm::ivec3 corners[4] = {
+				p,
+				p + glm::ivec3( 1, 0, 0 ),
+				p + glm::ivec3( 1, 1, 0 ),
+				p + glm::ivec3( 0, 1, 0 )
+			};
+			TerrainMesh::appendQuad( corners, 4, 1, 1, n & 7, &vertices, &indices );
+		}
+
+		sink += indices.size();
+		*quads += count;
+		return (double) count;
+	} );
+}
+
+
+/*!
+ * Frustum::cull against the bounds of every island mesh, with and without
+ * SIMD, from the middle of the world looking along x with the game's
+ * projection, then the front to back RenderQueue sort of what is visible,
+ * and occlusion culling of it by the solid faces of the same chunks. Also
+ * checks both frustum culls agree on every box, and the sort agrees with
+ * std::sort.
+ */
+void MicroBenchmark::culling( void )
+{
+	Terrain* terrain = new Terrain( WorldGenParams(), 0 );
+
+	BoxList boxes;
+	std::vector<glm::vec3>     origins;
+	std::vector<unsigned char> solids;
+	MeshData data;
+	for ( auto& c : terrain->getChunks() )
+	{
+		if ( !c.chunk->buildMesh( &data ) )
+			continue;
+
+		boxes.add( glm::vec3( data.offset + data.min ), glm::vec3( data.offset + data.max ) );
+		origins.push_back( glm::vec3( data.offset ) );
+		solids.push_back( data.solid );
+	}
+
+	delete terrain;
+
+	glm::vec3 eye( 144.0f, 64.0f, 144.0f );
+	glm::mat4 view = glm::lookAt( eye, eye + glm::vec3( 1.0f, 0.0f, 0.0f ), glm::vec3( 0.0f, 1.0f, 0.0f ) );
+	glm::mat4 projection = glm::perspective( glm::radians( 80.0f ), (float) WIN_W / WIN_H, 0.1f, 128.0f );
+
+	Frustum frustum;
+	frustum.extract( projection * view );
+
+	std::vector<unsigned char> visible( boxes.size() ), check( boxes.size() );
+	int shown = frustum.cull( boxes, &visible[0] );
+	frustum.cullScalar( boxes, &check[0] );
+
+	std::cout << "Culling " << boxes.size() << " chunk bounds: " << shown << " visible, "
+	          << ( visible == check ? "SIMD matches scalar" : "SIMD MISMATCH" ) << "\n";
+
+	measure( "frustum.cull", FIXTURE_ISLAND, 0.0, [&]( double* )
+	{
+		sink += frustum.cull( boxes, &visible[0] );
+		return (double) boxes.size();
+	} );
+
+	measure( "frustum.cull.scalar", FIXTURE_ISLAND, 0.0, [&]( double* )
+	{
+		sink += frustum.cullScalar( boxes, &check[0] );
+		return (double) boxes.size();
+	} );
+
+	// The visible boxes keyed by distance from the eye, as renderTerrain queues
+	// them, checked against std::sort.
+	std::vector<RenderItem> expected;
+	for ( int n = 0; n < boxes.size(); n++ )
+	{
+		if ( !visible[n] )
+			continue;
+
+		glm::vec3 c( boxes.cx[n], boxes.cy[n], boxes.cz[n] );
+		glm::vec3 e( boxes.ex[n], boxes.ey[n], boxes.ez[n] );
+		glm::vec3 lo = c - e, hi = c + e;
+		RenderItem item = { RenderQueue::makeKey( PASS_OPAQUE, 1, 1, glm::length( glm::clamp( eye, lo, hi ) - eye ) ), n };
+		expected.push_back( item );
+	}
+
+	RenderQueue queue;
+	auto fill = [&]( void )
+	{
+		queue.clear();
+		for ( auto& item : expected )
+			queue.push( item.key, item.index );
+	};
+
+	fill();
+	queue.sort();
+	std::stable_sort( expected.begin(), expected.end(), []( const RenderItem& a, const RenderItem& b ) {
+		return a.key < b.key;
+	} );
+
+	bool sorted = true;
+	for ( int i = 0; i < queue.size(); i++ )
+		sorted = sorted && queue[i].key == expected[i].key && queue[i].index == expected[i].index;
+
+	std::cout << "Render queue of " << queue.size() << " chunks: "
+	          << ( sorted ? "radix sort matches std::sort" : "SORT MISMATCH" ) << "\n";
+
+	measure( "renderqueue.sort", FIXTURE_ISLAND, 0.0, [&]( double* )
+	{
+		fill();
+		queue.sort();
+		sink += queue[0].index;
+		return (double) queue.size();
+	} );
+
+	// Drawing the occluders per occluder, and testing per chunk in view.
+	OcclusionCuller occlusion;
+	std::vector<unsigned char> unoccluded( visible );
+	auto occlude = [&]( void )
+	{
+		occlusion.begin( projection * view );
+		for ( int n = 0; n < boxes.size(); n++ )
+			if ( visible[n] )
+				occlusion.addSolidFaces( origins[n], (float) TRN_CHUNK_SIZE, solids[n] );
+		occlusion.render();
+	};
+
+	occlude();
+	int hidden = occlusion.cull( boxes, &unoccluded[0] );
+
+	std::cout << "Occlusion of " << shown << " chunks in view: " << hidden << " hidden by "
+	          << occlusion.getOccluders() << " occluders\n";
+
+	measure( "occlusion.render", FIXTURE_ISLAND, 0.0, [&]( double* )
+	{
+		occlude();
+		return (double) occlusion.getOccluders();
+	} );
+
+	measure( "occlusion.cull", FIXTURE_ISLAND, 0.0, [&]( double* )
+	{
+		unoccluded = visible;
+		sink += occlusion.cull( boxes, &unoccluded[0] );
+		return (double) shown;
+	} );
+}
+
+
+/*!
+ * glm::simplex and each Noise path the CPU supports, in 2D and 3D, over rows
+ * of points laid out as world generation samples them.
+ */
+void MicroBenchmark::noise( void )
+{
+	const int rows = 1024;
+	const int row  = TRN_CHUNK_SIZE;
+	const int n    = rows * row;
+
+	std::vector<float> x( n ), y( n ), z( n ), out( n );
+	for ( int r = 0; r < rows; r++ )
+	for ( int i = 0; i < row; i++ )
+	{
+		x[r * row + i] = (float) ( ( r % 64 * 16 ) / 30.0 );
+		y[r * row + i] = (float) ( ( r / 64 * 2 ) / 30.0 );
+		z[r * row + i] = (float) ( ( r * 7 % 288 + i ) / 30.0 );
+	}
+
+	const char* paths[3] = { "scalar", "sse4", "avx2" };
+	NoisePath original = Noise::getPath();
+
+	for ( int dims = 2; dims <= 3; dims++ )
+	{
+		std::string name = dims == 2 ? "noise.simplex2." : "noise.simplex3.";
+
+		measure( name + "glm", -1, 0.0, [&]( double* )
+		{
+			for ( int i = 0; i < n; i++ )
+				out[i] = dims == 2
+					? glm::simplex( glm::vec2( x[i], z[i] ) )
+					: glm::simplex( glm::vec3( x[i], y[i], z[i] ) );
+
+			sink += out[n / 2] > 0.0f;
+			return (double) n;
+		} );
+
+		for ( int p = NOISE_SCALAR; p <= NOISE_AVX2; p++ )
+		{
+			if ( !Noise::setPath( (NoisePath) p ) )
+				continue;
+
+			measure( name + paths[p], -1, 0.0, [&]( double* )
+			{
+				for ( int r = 0; r < rows; r++ )
+				{
+					if ( dims == 2 )
+						Noise::simplex( &x[r * row], &z[r * row], &out[r * row], row );
+					else
+						Noise::simplex( &x[r * row], &y[r * row], &z[r * row], &out[r * row], row );
+				}
+
+				sink += out[n / 2] > 0.0f;
+				return (double) n;
+			} );
+		}
+	}
+
+	Noise::setPath( original );
+}
+
+
+/*!
+ * Hills and caves on every island chunk, with the exact cave sampler and
+ * with lattices of increasing stride. Also reports the noise samples each
+ * takes per pass, and the share of blocks that come out different from the
+ * exact sampler.
+ */
+void MicroBenchmark::caves( void )
+{
+	const int size  = TRN_CHUNK_SIZE;
+	const int count = size * size * size;
+	WorldGenParams params;
+
+	std::cout << "Cave sampling...\n";
+
+	int columnCount = params.width * params.depth;
+	int chunkCount  = columnCount * params.height;
+
+	std::vector<ColumnData> columns( columnCount, ColumnData( size ) );
+	{
+		GenPipeline hills( size );
+		hills.add( new HillStage( params ) );
+		for ( int n = 0; n < columnCount; n++ )
+			hills.generateColumn( n / params.depth, n % params.depth, &columns[n] );
+	}
+
+	std::vector<Chunk*> chunks;
+	for ( int n = 0; n < chunkCount; n++ )
+		chunks.push_back( new Chunk( glm::ivec3( n / ( params.height * params.depth ), n / params.depth % params.height, n % params.depth ), size, nullptr ) );
+
+	std::vector<Block> exact( (size_t) chunkCount * count ), blocks( count );
+
+	const int strides[4] = { 1, 2, 4, 8 };
+	for ( int s = 0; s < 4; s++ )
+	{
+		params.caveStride = strides[s];
+
+		GenPipeline pipeline( size );
+		pipeline.add( new HillStage( params ) );
+		CaveStage* caves = new CaveStage( params );
+		pipeline.add( caves );
+
+		auto pass = [&]( void )
+		{
+			for ( auto c : chunks )
+			{
+				glm::ivec3 pos = c->getPosition();
+				pipeline.generateChunk( c, columns[pos.x * params.depth + pos.z] );
+			}
+		};
+
+		measure( "generate.caves.stride" + std::to_string( strides[s] ), FIXTURE_ISLAND, (double) count, [&]( double* )
+		{
+			pass();
+			return (double) chunkCount;
+		} );
+
+		long long samples = caves->getSamples();
+		pass();
+		samples = caves->getSamples() - samples;
+
+		long long differ = 0;
+		for ( int c = 0; c < chunkCount; c++ )
+		{
+			chunks[c]->unpack( &blocks[0] );
+			Block* reference = &exact[(size_t) c * count];
+			for ( int i = 0; i < count; i++ )
+			{
+				if ( s == 0 )
+					reference[i] = blocks[i];
+				else
+					differ += blocks[i].id != reference[i].id;
+			}
+		}
+
+		std::cout << std::fixed << std::setprecision( 3 )
+		          << "  stride " << strides[s] << ": " << samples << " samples per pass, "
+		          << 100.0 * differ / ( (double) chunkCount * count ) << "% of blocks differ from stride 1\n";
+	}
+
+	for ( auto c : chunks )
+		delete c;
+}
+
+
+/*!
+ * The island's generation passes on one thread: the column pass, the fused
+ * chunk pass, and each stage's share of both, from the pipeline's sampled
+ * timings.
+ */
+void MicroBenchmark::generation( void )
+{
+	const int size = TRN_CHUNK_SIZE;
+	const double voxels = (double) size * size * size;
+	WorldGenParams params;
+
+	std::cout << "Generation passes...\n";
+
+	GenPipeline pipeline( size );
+	pipeline.add( new HillStage( params ) );
+	pipeline.add( new CaveStage( params ) );
+	pipeline.add( new SealStage( params ) );
+
+	int columnCount = params.width * params.depth;
+	int chunkCount  = columnCount * params.height;
+
+	std::vector<ColumnData> columns( columnCount, ColumnData( size ) );
+	std::vector<Chunk*> chunks;
+	for ( int n = 0; n < chunkCount; n++ )
+		chunks.push_back( new Chunk( glm::ivec3( n / ( params.height * params.depth ), n / params.depth % params.height, n % params.depth ), size, nullptr ) );
+
+	measure( "generate.columns", FIXTURE_ISLAND, 0.0, [&]( double* )
+	{
+		for ( int n = 0; n < columnCount; n++ )
+			pipeline.generateColumn( n / params.depth, n % params.depth, &columns[n] );
+
+		return (double) columnCount;
+	} );
+
+	measure( "generate.chunks", FIXTURE_ISLAND, voxels, [&]( double* )
+	{
+		for ( auto c : chunks )
+		{
+			glm::ivec3 pos = c->getPosition();
+			pipeline.generateChunk( c, columns[pos.x * params.depth + pos.z] );
+		}
+
+		return (double) chunkCount;
+	} );
+
+	// One more timed run of both passes, split by stage.
+	pipeline.setTiming( true );
+	pipeline.resetTimings();
+	for ( int n = 0; n < columnCount; n++ )
+		pipeline.generateColumn( n / params.depth, n % params.depth, &columns[n] );
+	for ( auto c : chunks )
+	{
+		glm::ivec3 pos = c->getPosition();
+		pipeline.generateChunk( c, columns[pos.x * params.depth + pos.z] );
+	}
+
+	for ( int i = 0; i < pipeline.getStageCount(); i++ )
+	{
+		GenStage* s = pipeline.getStage( i );
+		Result r = { "generate.stage." + s->getName(), getFixtureName( FIXTURE_ISLAND ), (double) chunkCount, s->getTime(), voxels, 0.0, 0.0, 0.0 };
+		results.push_back( r );
+	}
+
+	for ( auto c : chunks )
+	{
+		sink += c->getHash();
+		delete c;
+	}
+
+	// Whole islands, as Terrain builds them, on one thread and on every
+	// hardware thread.
+	int threads[2] = { 1, ThreadPool::getHardwareThreads() };
+	const char* names[2] = { "terrain.generate.serial", "terrain.generate.parallel" };
+	for ( int t = 0; t < 2; t++ )
+	{
+		measure( names[t], FIXTURE_ISLAND, voxels * chunkCount, [&]( double* )
+		{
+			Terrain* terrain = new Terrain( params, threads[t] );
+			sink += terrain->getChunks().size();
+			delete terrain;
+
+			return 1.0;
+		} );
+	}
+}
+
+
+/*!
+ * Writes every result as JSON, along with the build configuration.
+ */
+void MicroBenchmark::write( std::string path )
+{
+	std::ofstream out( path );
+
+	out << "{\n"
+	    << "  \"config\": {\n"
+	    << "    \"chunk_size\": " << TRN_CHUNK_SIZE << ",\n"
+#ifdef TRN_PALETTE
+	    << "    \"storage\": \"palette\",\n"
+#else
+	    << "    \"storage\": \"flat\",\n"
+#endif
+#ifdef TRN_MORTON
+	    << "    \"morton\": true,\n"
+#else
+	    << "    \"morton\": false,\n"
+#endif
+	    << "    \"mesher\": \"" << ( Mesher::getType() == MESHER_BINARY ? "binary" : "greedy" ) << "\",\n"
+	    << "    \"noise\": \"" << Noise::getPathName( Noise::getPath() ) << "\",\n"
+	    << "    \"hardware_threads\": " << ThreadPool::getHardwareThreads() << "\n"
+	    << "  },\n"
+	    << "  \"results\": [\n";
+
+	out << std::setprecision( 6 );
+	for ( size_t i = 0; i < results.size(); i++ )
+	{
+		const Result& r = results[i];
+		double perSecond = r.ops / r.seconds;
+
+		out << "    { \"name\": \"" << r.name << "\"";
+		if ( !r.fixture.empty() )
+			out << ", \"fixture\": \"" << r.fixture << "\"";
+		out << ", \"ops\": " << r.ops
+		    << ", \"seconds\": " << r.seconds
+		    << ", \"ns_per_op\": " << r.seconds / r.ops * 1e9
+		    << ", \"allocs_per_op\": " << r.allocsPerOp;
+		if ( r.voxelsPerOp > 0.0 )
+			out << ", \"voxels_per_s\": " << perSecond * r.voxelsPerOp;
+		if ( r.quadsPerOp > 0.0 )
+			out << ", \"quads_per_s\": " << perSecond * r.quadsPerOp
+			    << ", \"quads_per_op\": " << r.quadsPerOp;
+		if ( r.bytesPerChunk > 0.0 )
+			out << ", \"bytes_per_chunk\": " << r.bytesPerChunk;
+		out << " }" << ( i + 1 < results.size() ? "," : "" ) << "\n";
+	}
+
+	out << "  ]\n"
+	    << "}\n";
+}
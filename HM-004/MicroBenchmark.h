@@ -0,0 +1,65 @@
+#pragma once
+
+
+class Chunk;
+class Terrain;
+
+
+/*!
+ * Microbenchmarks of the terrain hot paths (block lookups, flat and palette
+ * storage, both meshers, quad emission, frustum and occlusion culling, render
+ * queue sorting, noise, cave sampling and generation) on synthetic and
+ * generated chunk fixtures. Results go to microbenchmark.json, one record per
+ * benchmark and fixture with ns/op, heap allocations per op and, where they
+ * apply, voxels/s, quads/s and storage bytes per chunk, so runs can be
+ * diffed across commits. Needs no window; runs in place of the
+ * game when built with MICROBENCH_MODE, as the hm004-microbench target of
+ * CMakeLists.txt does, linking the sources Headless does plus Frustum,
+ * OcclusionCuller and RenderQueue.
+ */
+class MicroBenchmark {
+private:
+	enum Fixture {
+		FIXTURE_EMPTY = 0,
+		FIXTURE_FULL,
+		FIXTURE_CHECKERBOARD,
+		FIXTURE_NOISE,
+		FIXTURE_ISLAND,
+		FIXTURE_COUNT
+	};
+
+	struct Result {
+		std::string name;
+		std::string fixture;
+		double ops;
+		double seconds;
+		double voxelsPerOp;
+		double quadsPerOp;
+		double allocsPerOp;
+		double bytesPerChunk;
+	};
+
+	static std::vector<Result> results;
+	static unsigned long long sink;
+
+	static const char* getFixtureName( int fixture );
+	static Terrain*    createFixture( int fixture, std::vector<Chunk*>* targets );
+
+	static void measure( std::string name, int fixture, double voxelsPerOp, std::function<double( double* quads )> pass );
+
+	static void chunkLookup( int fixture, const std::vector<Chunk*>& targets );
+	static void terrainLookup( int fixture, Terrain* terrain, const std::vector<Chunk*>& targets );
+	static void storage( int fixture, const std::vector<Chunk*>& targets );
+	static void meshing( int fixture, const std::vector<Chunk*>& targets );
+	static void meshers( int fixture, Terrain* terrain, const std::vector<Chunk*>& targets );
+	static void quads( void );
+	static void culling( void );
+	static void noise( void );
+	static void caves( void );
+	static void generation( void );
+
+	static void write( std::string path );
+
+public:
+	static void run( void );
+};
@@ -0,0 +1,202 @@
+#include "Base.h"
+#include "Noise.h"
+
+#ifdef TRN_SIMD
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+
+// Scalar lane operations for NoiseLanes.inl.
+typedef float V;
+
+static inline V vset( float f )   { return f; }
+static inline V vadd( V a, V b )  { return a + b; }
+static inline V vsub( V a, V b )  { return a - b; }
+static inline V vmul( V a, V b )  { return a * b; }
+static inline V vmin( V a, V b )  { return b < a ? b : a; }
+static inline V vmax( V a, V b )  { return a < b ? b : a; }
+static inline V vfloor( V a )     { return floorf( a ); }
+static inline V vabs( V a )       { return fabsf( a ); }
+static inline V vneg( V a )       { return -a; }
+static inline V vge( V a, V b )   { return a >= b ? 1.0f : 0.0f; }
+static inline V vgt( V a, V b )   { return a > b ? 1.0f : 0.0f; }
+
+#include "NoiseLanes.inl"
+
+
+NoisePath Noise::best = Noise::detect();
+NoisePath Noise::path = Noise::best;
+
+
+/*!
+ * Returns the widest instruction set both the CPU and the OS support.
+ */
+NoisePath Noise::detect( void )
+{
+#ifdef TRN_SIMD
+	int info[4];
+
+#ifdef _MSC_VER
+	__cpuid( info, 0 );
+#else
+	__cpuid( 0, info[0], info[1], info[2], info[3] );
+#endif
+	int leaves = info[0];
+
+#ifdef _MSC_VER
+	__cpuid( info, 1 );
+#else
+	__cpuid( 1, info[0], info[1], info[2], info[3] );
+#endif
+	bool sse4    = ( info[2] & ( 1 << 19 ) ) != 0;
+	bool osxsave = ( info[2] & ( 1 << 27 ) ) != 0;
+	bool avx     = ( info[2] & ( 1 << 28 ) ) != 0;
+
+	// AVX registers are only usable if the OS saves them on context switch.
+	if ( avx && osxsave )
+	{
+#ifdef _MSC_VER
+		unsigned long long xcr0 = _xgetbv( 0 );
+#else
+		unsigned int lo, hi;
+		__asm__ __volatile__ ( "xgetbv" : "=a" ( lo ), "=d" ( hi ) : "c" ( 0 ) );
+		unsigned long long xcr0 = ( (unsigned long long) hi << 32 ) | lo;
+#endif
+		avx = ( xcr0 & 6 ) == 6;
+	} else
+		avx = false;
+
+	bool avx2 = false;
+	if ( avx && leaves >= 7 )
+	{
+#ifdef _MSC_VER
+		__cpuidex( info, 7, 0 );
+#else
+		__cpuid_count( 7, 0, info[0], info[1], info[2], info[3] );
+#endif
+		avx2 = ( info[1] & ( 1 << 5 ) ) != 0;
+	}
+
+	if ( avx2 )
+		return NOISE_AVX2;
+	if ( sse4 )
+		return NOISE_SSE4;
+#endif
+
+	return NOISE_SCALAR;
+}
+
+
+/*!
+ * Returns 2D simplex noise at a single point.
+ */
+float Noise::simplex( glm::vec2 v )
+{
+	return vsimplex2( v.x, v.y );
+}
+
+
+/*!
+ * Returns 3D simplex noise at a single point.
+ */
+float Noise::simplex( glm::vec3 v )
+{
+	return vsimplex3( v.x, v.y, v.z );
+}
+
+
+/*!
+ * Writes 2D simplex noise at the n points (x[i], y[i]) to out.
+ */
+void Noise::simplex( const float* x, const float* y, float* out, int n )
+{
+	switch ( path )
+	{
+#ifdef TRN_SIMD
+	case NOISE_AVX2: simplexAVX2( x, y, out, n ); break;
+	case NOISE_SSE4: simplexSSE4( x, y, out, n ); break;
+#endif
+	default:         simplexScalar( x, y, out, n );
+	}
+}
+
+
+/*!
+ * Writes 3D simplex noise at the n points (x[i], y[i], z[i]) to out.
+ */
+void Noise::simplex( const float* x, const float* y, const float* z, float* out, int n )
+{
+	switch ( path )
+	{
+#ifdef TRN_SIMD
+	case NOISE_AVX2: simplexAVX2( x, y, z, out, n ); break;
+	case NOISE_SSE4: simplexSSE4( x, y, z, out, n ); break;
+#endif
+	default:         simplexScalar( x, y, z, out, n );
+	}
+}
+
+
+void Noise::simplexScalar( const float* x, const float* y, float* out, int n )
+{
+	for ( int i = 0; i < n; i++ )
+		out[i] = vsimplex2( x[i], y[i] );
+}
+
+
+void Noise::simplexScalar( const float* x, const float* y, const float* z, float* out, int n )
+{
+	for ( int i = 0; i < n; i++ )
+		out[i] = vsimplex3( x[i], y[i], z[i] );
+}
+
+
+/*!
+ * Returns the instruction set the batch functions currently use.
+ */
+NoisePath Noise::getPath( void )
+{
+	return path;
+}
+
+
+/*!
+ * Returns the widest instruction set detected at startup.
+ */
+NoisePath Noise::getBestPath( void )
+{
+	return best;
+}
+
+
+/*!
+ * Forces the batch functions onto the given instruction set, for testing and
+ * benchmarks. Returns false, changing nothing, if the CPU lacks it.
+ */
+bool Noise::setPath( NoisePath path )
+{
+	if ( path > best )
+		return false;
+
+	Noise::path = path;
+
+	return true;
+}
+
+
+/*!
+ * Returns a printable name for an instruction set.
+ */
+const char* Noise::getPathName( NoisePath path )
+{
+	switch ( path )
+	{
+	case NOISE_AVX2: return "AVX2";
+	case NOISE_SSE4: return "SSE4.1";
+	default:         return "scalar";
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+
+#include "MacroTerrain.h"
+
+
+enum NoisePath {
+	NOISE_SCALAR = 0,
+	NOISE_SSE4,
+	NOISE_AVX2
+};
+
+
+/*!
+ * Simplex noise evaluated over arrays of points, 4 (SSE4.1) or 8 (AVX2) at a
+ * time, using the widest instruction set the CPU reports at startup. All
+ * paths give bit-identical results, and agree with glm::simplex to within
+ * 1e-5 absolute on the ranges world generation samples; the only change to
+ * glm's arithmetic is a multiply by 1 / 289 in place of a divide when
+ * wrapping lattice coordinates. Tests::noisePaths checks every path against
+ * glm, and Tests::goldenHashes checks whole worlds.
+ */
+class Noise {
+private:
+	static NoisePath best;
+	static NoisePath path;
+
+	static NoisePath detect( void );
+
+	static void simplexScalar( const float* x, const float* y, float* out, int n );
+	static void simplexScalar( const float* x, const float* y, const float* z, float* out, int n );
+
+#ifdef TRN_SIMD
+	static void simplexSSE4( const float* x, const float* y, float* out, int n );
+	static void simplexSSE4( const float* x, const float* y, const float* z, float* out, int n );
+
+	static void simplexAVX2( const float* x, const float* y, float* out, int n );
+	static void simplexAVX2( const float* x, const float* y, const float* z, float* out, int n );
+#endif
+
+public:
+	static float simplex( glm::vec2 v );
+	static float simplex( glm::vec3 v );
+
+	static void simplex( const float* x, const float* y, float* out, int n );
+	static void simplex( const float* x, const float* y, const float* z, float* out, int n );
+
+	static NoisePath getPath( void );
+	static NoisePath getBestPath( void );
+	static bool      setPath( NoisePath path );
+
+	static const char* getPathName( NoisePath path );
+};
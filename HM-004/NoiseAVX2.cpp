@@ -0,0 +1,84 @@
+#include "Base.h"
+#include "Noise.h"
+
+#ifdef TRN_SIMD
+
+#include <immintrin.h>
+
+// Only the code below is built for AVX2, so that inline functions from shared
+// headers are never compiled with instructions older CPUs lack. MSVC needs no
+// flag to emit intrinsics.
+#if defined( __clang__ )
+#pragma clang attribute push( __attribute__(( target( "avx2" ) )), apply_to = function )
+#elif defined( __GNUC__ )
+#pragma GCC push_options
+#pragma GCC target( "avx2" )
+#endif
+
+
+// AVX2 lane operations for NoiseLanes.inl, eight points per register.
+typedef __m256 V;
+
+static inline V vset( float f )   { return _mm256_set1_ps( f ); }
+static inline V vadd( V a, V b )  { return _mm256_add_ps( a, b ); }
+static inline V vsub( V a, V b )  { return _mm256_sub_ps( a, b ); }
+static inline V vmul( V a, V b )  { return _mm256_mul_ps( a, b ); }
+static inline V vmin( V a, V b )  { return _mm256_min_ps( b, a ); }
+static inline V vmax( V a, V b )  { return _mm256_max_ps( b, a ); }
+static inline V vfloor( V a )     { return _mm256_floor_ps( a ); }
+static inline V vabs( V a )       { return _mm256_andnot_ps( _mm256_set1_ps( -0.0f ), a ); }
+static inline V vneg( V a )       { return _mm256_xor_ps( _mm256_set1_ps( -0.0f ), a ); }
+static inline V vge( V a, V b )   { return _mm256_and_ps( _mm256_cmp_ps( a, b, _CMP_GE_OQ ), _mm256_set1_ps( 1.0f ) ); }
+static inline V vgt( V a, V b )   { return _mm256_and_ps( _mm256_cmp_ps( a, b, _CMP_GT_OQ ), _mm256_set1_ps( 1.0f ) ); }
+
+#include "NoiseLanes.inl"
+
+
+/*!
+ * 2D simplex noise, eight points at a time. A partial final group is padded
+ * through a small buffer.
+ */
+void Noise::simplexAVX2( const float* x, const float* y, float* out, int n )
+{
+	int i = 0;
+	for ( ; i + 8 <= n; i += 8 )
+		_mm256_storeu_ps( out + i, vsimplex2( _mm256_loadu_ps( x + i ), _mm256_loadu_ps( y + i ) ) );
+
+	if ( i < n )
+	{
+		float bx[8] = { 0 }, by[8] = { 0 }, bo[8];
+		memcpy( bx, x + i, sizeof ( float ) * ( n - i ) );
+		memcpy( by, y + i, sizeof ( float ) * ( n - i ) );
+		_mm256_storeu_ps( bo, vsimplex2( _mm256_loadu_ps( bx ), _mm256_loadu_ps( by ) ) );
+		memcpy( out + i, bo, sizeof ( float ) * ( n - i ) );
+	}
+}
+
+
+/*!
+ * 3D simplex noise, eight points at a time.
+ */
+void Noise::simplexAVX2( const float* x, const float* y, const float* z, float* out, int n )
+{
+	int i = 0;
+	for ( ; i + 8 <= n; i += 8 )
+		_mm256_storeu_ps( out + i, vsimplex3( _mm256_loadu_ps( x + i ), _mm256_loadu_ps( y + i ), _mm256_loadu_ps( z + i ) ) );
+
+	if ( i < n )
+	{
+		float bx[8] = { 0 }, by[8] = { 0 }, bz[8] = { 0 }, bo[8];
+		memcpy( bx, x + i, sizeof ( float ) * ( n - i ) );
+		memcpy( by, y + i, sizeof ( float ) * ( n - i ) );
+		memcpy( bz, z + i, sizeof ( float ) * ( n - i ) );
+		_mm256_storeu_ps( bo, vsimplex3( _mm256_loadu_ps( bx ), _mm256_loadu_ps( by ), _mm256_loadu_ps( bz ) ) );
+		memcpy( out + i, bo, sizeof ( float ) * ( n - i ) );
+	}
+}
+
+#if defined( __clang__ )
+#pragma clang attribute pop
+#elif defined( __GNUC__ )
+#pragma GCC pop_options
+#endif
+
+#endif
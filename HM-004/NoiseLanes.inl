@@ -0,0 +1,197 @@
+/*!
+ * Simplex noise kernels written once against a small set of lane operations,
+ * and included by each instruction set's translation unit after it defines
+ * them for its own lane type V:
+ *
+ *   vset( f )       every lane set to f
+ *   vadd, vsub, vmul, vmin, vmax
+ *   vfloor, vabs, vneg
+ *   vge( a, b )     1 where a >= b, else 0
+ *   vgt( a, b )     1 where a > b, else 0
+ *
+ * The arithmetic follows glm's simplex() (gtc/noise.inl) step for step, in the
+ * same order and without fused multiply-adds, so every instruction set gives
+ * bit-identical results. The only departure from glm is that the modulo 289
+ * reductions multiply by 1 / 289 rather than divide. See Noise.h for the
+ * resulting tolerance.
+ */
+
+
+static inline V vmod289( V x )
+{
+	return vsub( x, vmul( vfloor( vmul( x, vset( 1.0f / 289.0f ) ) ), vset( 289.0f ) ) );
+}
+
+
+static inline V vpermute( V x )
+{
+	return vmod289( vmul( vadd( vmul( x, vset( 34.0f ) ), vset( 1.0f ) ), x ) );
+}
+
+
+static inline V vtaylorInvSqrt( V r )
+{
+	return vsub( vset( 1.79284291400159f ), vmul( vset( 0.85373472095314f ), r ) );
+}
+
+
+/*!
+ * 2D simplex noise, one point per lane.
+ */
+static inline V vsimplex2( V vx, V vy )
+{
+	const V C0 = vset(  0.211324865405187f ); // ( 3 - sqrt( 3 ) ) / 6
+	const V C1 = vset(  0.366025403784439f ); // ( sqrt( 3 ) - 1 ) / 2
+	const V C2 = vset( -0.577350269189626f ); // -1 + 2 * C0
+	const V C3 = vset(  0.024390243902439f ); // 1 / 41
+	const V zero = vset( 0.0f );
+	const V one  = vset( 1.0f );
+	const V half = vset( 0.5f );
+
+	// First corner.
+	V s  = vadd( vmul( vx, C1 ), vmul( vy, C1 ) );
+	V ix = vfloor( vadd( vx, s ) );
+	V iy = vfloor( vadd( vy, s ) );
+	V t  = vadd( vmul( ix, C0 ), vmul( iy, C0 ) );
+	V x0 = vadd( vsub( vx, ix ), t );
+	V y0 = vadd( vsub( vy, iy ), t );
+
+	// Other corners.
+	V i1x = vgt( x0, y0 );
+	V i1y = vsub( one, i1x );
+	V x1 = vsub( vadd( x0, C0 ), i1x );
+	V y1 = vsub( vadd( y0, C0 ), i1y );
+	V x2 = vadd( x0, C2 );
+	V y2 = vadd( y0, C2 );
+
+	// Permutations.
+	ix = vmod289( ix );
+	iy = vmod289( iy );
+	V p0 = vpermute( vadd( vadd( vpermute( iy ),                  ix ), zero ) );
+	V p1 = vpermute( vadd( vadd( vpermute( vadd( iy, i1y ) ),     ix ), i1x  ) );
+	V p2 = vpermute( vadd( vadd( vpermute( vadd( iy, one ) ),     ix ), one  ) );
+
+	V m0 = vmax( vsub( half, vadd( vmul( x0, x0 ), vmul( y0, y0 ) ) ), zero );
+	V m1 = vmax( vsub( half, vadd( vmul( x1, x1 ), vmul( y1, y1 ) ) ), zero );
+	V m2 = vmax( vsub( half, vadd( vmul( x2, x2 ), vmul( y2, y2 ) ) ), zero );
+	m0 = vmul( m0, m0 ); m0 = vmul( m0, m0 );
+	m1 = vmul( m1, m1 ); m1 = vmul( m1, m1 );
+	m2 = vmul( m2, m2 ); m2 = vmul( m2, m2 );
+
+	// Gradients: 41 points over a line, mapped onto a diamond.
+	V gx0 = vsub( vmul( vset( 2.0f ), vsub( vmul( p0, C3 ), vfloor( vmul( p0, C3 ) ) ) ), one );
+	V gx1 = vsub( vmul( vset( 2.0f ), vsub( vmul( p1, C3 ), vfloor( vmul( p1, C3 ) ) ) ), one );
+	V gx2 = vsub( vmul( vset( 2.0f ), vsub( vmul( p2, C3 ), vfloor( vmul( p2, C3 ) ) ) ), one );
+	V h0 = vsub( vabs( gx0 ), half );
+	V h1 = vsub( vabs( gx1 ), half );
+	V h2 = vsub( vabs( gx2 ), half );
+	V a0 = vsub( gx0, vfloor( vadd( gx0, half ) ) );
+	V a1 = vsub( gx1, vfloor( vadd( gx1, half ) ) );
+	V a2 = vsub( gx2, vfloor( vadd( gx2, half ) ) );
+
+	// Normalise gradients implicitly by scaling m.
+	m0 = vmul( m0, vtaylorInvSqrt( vadd( vmul( a0, a0 ), vmul( h0, h0 ) ) ) );
+	m1 = vmul( m1, vtaylorInvSqrt( vadd( vmul( a1, a1 ), vmul( h1, h1 ) ) ) );
+	m2 = vmul( m2, vtaylorInvSqrt( vadd( vmul( a2, a2 ), vmul( h2, h2 ) ) ) );
+
+	V g0 = vadd( vmul( a0, x0 ), vmul( h0, y0 ) );
+	V g1 = vadd( vmul( a1, x1 ), vmul( h1, y1 ) );
+	V g2 = vadd( vmul( a2, x2 ), vmul( h2, y2 ) );
+
+	return vmul( vset( 130.0f ), vadd( vadd( vmul( m0, g0 ), vmul( m1, g1 ) ), vmul( m2, g2 ) ) );
+}
+
+
+/*!
+ * Contribution of one corner of a 3D simplex, given its permuted hash and
+ * its offset from the point.
+ */
+static inline V vcorner3( V p, V x, V y, V z, V& m )
+{
+	const float n_ = 0.142857142857f; // 1 / 7
+	const V nsx = vset( n_ * 2.0f );
+	const V nsy = vset( n_ * 0.5f - 1.0f );
+	const V nsz = vset( n_ );
+	const V zero = vset( 0.0f );
+	const V one  = vset( 1.0f );
+	const V two  = vset( 2.0f );
+
+	// Gradients: 7x7 points over a square, mapped onto an octahedron.
+	V j  = vsub( p, vmul( vset( 49.0f ), vfloor( vmul( vmul( p, nsz ), nsz ) ) ) );
+	V x_ = vfloor( vmul( j, nsz ) );
+	V y_ = vfloor( vsub( j, vmul( vset( 7.0f ), x_ ) ) );
+
+	V gx = vadd( vmul( x_, nsx ), nsy );
+	V gy = vadd( vmul( y_, nsx ), nsy );
+	V gz = vsub( vsub( one, vabs( gx ) ), vabs( gy ) );
+
+	V sh = vneg( vge( zero, gz ) );
+	gx = vadd( gx, vmul( vadd( vmul( vfloor( gx ), two ), one ), sh ) );
+	gy = vadd( gy, vmul( vadd( vmul( vfloor( gy ), two ), one ), sh ) );
+
+	// Normalise the gradient.
+	V norm = vtaylorInvSqrt( vadd( vadd( vmul( gx, gx ), vmul( gy, gy ) ), vmul( gz, gz ) ) );
+	gx = vmul( gx, norm );
+	gy = vmul( gy, norm );
+	gz = vmul( gz, norm );
+
+	m = vmax( vsub( vset( 0.6f ), vadd( vadd( vmul( x, x ), vmul( y, y ) ), vmul( z, z ) ) ), zero );
+	m = vmul( m, m );
+	m = vmul( m, m );
+
+	return vadd( vadd( vmul( gx, x ), vmul( gy, y ) ), vmul( gz, z ) );
+}
+
+
+/*!
+ * 3D simplex noise, one point per lane.
+ */
+static inline V vsimplex3( V vx, V vy, V vz )
+{
+	const V Cx = vset( 1.0f / 6.0f );
+	const V Cy = vset( 1.0f / 3.0f );
+	const V one  = vset( 1.0f );
+	const V half = vset( 0.5f );
+
+	// First corner.
+	V s  = vadd( vadd( vmul( vx, Cy ), vmul( vy, Cy ) ), vmul( vz, Cy ) );
+	V ix = vfloor( vadd( vx, s ) );
+	V iy = vfloor( vadd( vy, s ) );
+	V iz = vfloor( vadd( vz, s ) );
+	V t  = vadd( vadd( vmul( ix, Cx ), vmul( iy, Cx ) ), vmul( iz, Cx ) );
+	V x0 = vadd( vsub( vx, ix ), t );
+	V y0 = vadd( vsub( vy, iy ), t );
+	V z0 = vadd( vsub( vz, iz ), t );
+
+	// Other corners.
+	V gx = vge( x0, y0 );
+	V gy = vge( y0, z0 );
+	V gz = vge( z0, x0 );
+	V lx = vsub( one, gx );
+	V ly = vsub( one, gy );
+	V lz = vsub( one, gz );
+	V i1x = vmin( gx, lz ), i1y = vmin( gy, lx ), i1z = vmin( gz, ly );
+	V i2x = vmax( gx, lz ), i2y = vmax( gy, lx ), i2z = vmax( gz, ly );
+
+	V x1 = vadd( vsub( x0, i1x ), Cx ), y1 = vadd( vsub( y0, i1y ), Cx ), z1 = vadd( vsub( z0, i1z ), Cx );
+	V x2 = vadd( vsub( x0, i2x ), Cy ), y2 = vadd( vsub( y0, i2y ), Cy ), z2 = vadd( vsub( z0, i2z ), Cy );
+	V x3 = vsub( x0, half ),            y3 = vsub( y0, half ),            z3 = vsub( z0, half );
+
+	// Permutations.
+	ix = vmod289( ix );
+	iy = vmod289( iy );
+	iz = vmod289( iz );
+	V p0 = vpermute( vadd( vadd( vpermute( vadd( vadd( vpermute( iz ), iy ), vset( 0.0f ) ) ), ix ), vset( 0.0f ) ) );
+	V p1 = vpermute( vadd( vadd( vpermute( vadd( vadd( vpermute( vadd( iz, i1z ) ), iy ), i1y ) ), ix ), i1x ) );
+	V p2 = vpermute( vadd( vadd( vpermute( vadd( vadd( vpermute( vadd( iz, i2z ) ), iy ), i2y ) ), ix ), i2x ) );
+	V p3 = vpermute( vadd( vadd( vpermute( vadd( vadd( vpermute( vadd( iz, one ) ), iy ), one ) ), ix ), one ) );
+
+	// Mix final noise value.
+	V m0, m1, m2, m3;
+	V d0 = vcorner3( p0, x0, y0, z0, m0 );
+	V d1 = vcorner3( p1, x1, y1, z1, m1 );
+	V d2 = vcorner3( p2, x2, y2, z2, m2 );
+	V d3 = vcorner3( p3, x3, y3, z3, m3 );
+
+	return vmul( vset( 42.0f ), vadd( vadd( vmul( m0, d0 ), vmul( m1, d1 ) ), vadd( vmul( m2, d2 ), vmul( m3, d3 ) ) ) );
+}
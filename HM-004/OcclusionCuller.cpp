@@ -0,0 +1,472 @@
+#include "Base.h"
+#include "OcclusionCuller.h"
+
+#include "Frustum.h"
+
+#include <cfloat>
+#include <climits>
+
+#ifdef TRN_SIMD
+#include <xmmintrin.h>
+#endif
+
+
+// Distance in front of the eye, in blocks, at which occluders are clipped and
+// closer boxes are always visible. Further than the near plane keeps screen
+// coordinates small.
+#define OC_NEAR 1.0f
+
+// Fraction by which occluder depth is pushed back, so that a face never hides
+// the box it bounds.
+#define OC_BIAS 0.001f
+
+
+/*!
+ * Allocates the depth buffer and starts the threads.
+ */
+OcclusionCuller::OcclusionCuller( int width, int height, int threads ) :
+	width( width ),
+	height( height ),
+	depth( width * height, 0.0f ),
+	viewProjection( 1.0f ),
+	occluders( 0 ),
+	pool( threads )
+{
+	if ( width % 4 != 0 )
+		throw std::runtime_error( "Occlusion buffer width must be a multiple of four." );
+
+	rejected.resize( pool.getThreadCount() );
+}
+
+
+/*!
+ * Starts a new frame seen through the given projection times view matrix,
+ * dropping the occluders of the last.
+ */
+void OcclusionCuller::begin( const glm::mat4& viewProjection )
+{
+	this->viewProjection = viewProjection;
+	polygons.clear();
+	occluders = 0;
+}
+
+
+/*!
+ * Adds an opaque quad, given by its corners in world space in order around
+ * it. Either side may face the eye. It is clipped against OC_NEAR and set up
+ * for drawing; nothing is drawn until render().
+ */
+void OcclusionCuller::addOccluder( const glm::vec3 corners[4] )
+{
+	glm::vec4 clip[4];
+	for ( int i = 0; i < 4; i++ )
+		clip[i] = viewProjection * glm::vec4( corners[i], 1.0f );
+
+	// Sutherland-Hodgman against the one plane, which leaves at most five.
+	glm::vec4 poly[5];
+	int count = 0;
+	for ( int i = 0; i < 4; i++ )
+	{
+		const glm::vec4& a = clip[i];
+		const glm::vec4& b = clip[( i + 1 ) & 3];
+		float da = a.w - OC_NEAR;
+		float db = b.w - OC_NEAR;
+
+		if ( da >= 0.0f )
+			poly[count++] = a;
+
+		if ( ( da >= 0.0f ) != ( db >= 0.0f ) )
+			poly[count++] = a + ( b - a ) * ( da / ( da - db ) );
+	}
+
+	if ( count < 3 )
+		return;
+
+	addPolygon( poly, count );
+	occluders++;
+}
+
+
+/*!
+ * Adds the faces of a cube, given by its minimum corner and size, marked in
+ * a mask with a bit per normal (+x, -x, +y, -y, +z, -z), as from
+ * Mesher::findSolidFaces.
+ */
+void OcclusionCuller::addSolidFaces( glm::vec3 origin, float size, unsigned char faces )
+{
+	for ( int n = 0; n < 6; n++ )
+	{
+		if ( !( faces >> n & 1 ) )
+			continue;
+
+		int d = n / 2;
+		int u = ( d == 0 ) ? 2 : 0;
+		int v = ( d == 1 ) ? 2 : 1;
+
+		glm::vec3 p = origin, du( 0.0f ), dv( 0.0f );
+		p[d] += ( n & 1 ) ? 0.0f : size;
+		du[u] = size;
+		dv[v] = size;
+
+		glm::vec3 corners[4] = { p, p + du, p + du + dv, p + dv };
+		addOccluder( corners );
+	}
+}
+
+
+/*!
+ * Projects a clipped convex polygon of up to five corners to the buffer and
+ * sets up its edge functions and depth plane. Polygons off screen or with no
+ * area are dropped.
+ */
+void OcclusionCuller::addPolygon( const glm::vec4* clip, int count )
+{
+	float x[5], y[5], z[5];
+
+	for ( int i = 0; i < count; i++ )
+	{
+		z[i] = 1.0f / clip[i].w;
+		x[i] = ( clip[i].x * z[i] * 0.5f + 0.5f ) * width;
+		y[i] = ( clip[i].y * z[i] * 0.5f + 0.5f ) * height;
+	}
+
+	// Twice the signed area, and the largest triangle of the fan from the
+	// first corner, to take the depth plane from.
+	float area = 0.0f, largest = 0.0f;
+	int   apex = 1;
+	for ( int i = 1; i + 1 < count; i++ )
+	{
+		float a = ( x[i] - x[0] ) * ( y[i + 1] - y[0] ) - ( x[i + 1] - x[0] ) * ( y[i] - y[0] );
+		area += a;
+		if ( fabsf( a ) > largest )
+		{
+			largest = fabsf( a );
+			apex = i;
+		}
+	}
+
+	if ( largest == 0.0f )
+		return;
+
+	// Wind every polygon the same way, so inside is where all edges agree.
+	if ( area < 0.0f )
+	{
+		std::reverse( x + 1, x + count );
+		std::reverse( y + 1, y + count );
+		std::reverse( z + 1, z + count );
+		apex = count - 1 - apex;
+	}
+
+	Polygon p;
+	p.minX = p.minY = INT_MAX;
+	p.maxX = p.maxY = INT_MIN;
+	for ( int i = 0; i < count; i++ )
+	{
+		p.minX = std::min( p.minX, (int) floorf( x[i] ) );
+		p.maxX = std::max( p.maxX, (int)  ceilf( x[i] ) );
+		p.minY = std::min( p.minY, (int) floorf( y[i] ) );
+		p.maxY = std::max( p.maxY, (int)  ceilf( y[i] ) );
+	}
+
+	p.minX = std::max( p.minX, 0 ); p.maxX = std::min( p.maxX, width - 1 );
+	p.minY = std::max( p.minY, 0 ); p.maxY = std::min( p.maxY, height - 1 );
+
+	if ( p.minX > p.maxX || p.minY > p.maxY )
+		return;
+
+	// Edge i runs from corner i to the next, and is positive on the inside.
+	// Each is moved inwards by half a pixel along both axes, so that it is
+	// positive at a pixel's centre only if it is at every corner: a pixel is
+	// covered only if the polygon covers all of it.
+	for ( int i = 0; i < 5; i++ )
+	{
+		if ( i >= count )
+		{
+			p.edgeA[i] = p.edgeB[i] = p.edgeC[i] = 0.0f;
+			continue;
+		}
+
+		int j = ( i + 1 ) % count;
+		p.edgeA[i] = y[i] - y[j];
+		p.edgeB[i] = x[j] - x[i];
+		p.edgeC[i] = -p.edgeA[i] * x[i] - p.edgeB[i] * y[i] - 0.5f * ( fabsf( p.edgeA[i] ) + fabsf( p.edgeB[i] ) );
+	}
+
+	// 1 / w is linear on screen. Taking it at the farthest corner of each
+	// pixel rather than its centre, and a little further, keeps it behind the
+	// occluder everywhere in the pixel.
+	int   i1 = apex, i2 = apex + 1;
+	float tri = ( x[i1] - x[0] ) * ( y[i2] - y[0] ) - ( x[i2] - x[0] ) * ( y[i1] - y[0] );
+	float dz1 = z[i1] - z[0], dz2 = z[i2] - z[0];
+	float a0 = ( dz1 * ( y[i2] - y[0] ) - dz2 * ( y[i1] - y[0] ) ) / tri;
+	float b0 = ( dz2 * ( x[i1] - x[0] ) - dz1 * ( x[i2] - x[0] ) ) / tri;
+	float c0 = z[0] - a0 * x[0] - b0 * y[0] - 0.5f * ( fabsf( a0 ) + fabsf( b0 ) );
+
+	p.depthA = a0 * ( 1.0f - OC_BIAS );
+	p.depthB = b0 * ( 1.0f - OC_BIAS );
+	p.depthC = c0 * ( 1.0f - OC_BIAS );
+
+	polygons.push_back( p );
+}
+
+
+/*!
+ * Clears rows top to bottom, exclusive, of the buffer and draws every
+ * polygon touching them. A pixel is covered if its centre is inside the
+ * polygon's inset edges, so if the whole pixel is inside the polygon, and
+ * keeps the nearest depth written to it.
+ */
+void OcclusionCuller::drawBand( int top, int bottom )
+{
+	std::fill( depth.begin() + top * width, depth.begin() + bottom * width, 0.0f );
+
+	for ( const Polygon& p : polygons )
+	{
+		int y0 = std::max( p.minY, top );
+		int y1 = std::min( p.maxY, bottom - 1 );
+
+#ifdef TRN_SIMD
+		// Four pixels at a time from a multiple of four, which the width is,
+		// so no group runs off the row.
+		int x0 = p.minX & ~3;
+
+		__m128 a[5], b[5], c[5];
+		for ( int e = 0; e < 5; e++ )
+		{
+			a[e] = _mm_set1_ps( p.edgeA[e] );
+			b[e] = _mm_set1_ps( p.edgeB[e] );
+			c[e] = _mm_set1_ps( p.edgeC[e] );
+		}
+
+		__m128 za = _mm_set1_ps( p.depthA ), zb = _mm_set1_ps( p.depthB ), zc = _mm_set1_ps( p.depthC );
+		__m128 zero  = _mm_setzero_ps();
+		__m128 four  = _mm_set1_ps( 4.0f );
+		__m128 start = _mm_add_ps( _mm_set1_ps( (float) x0 ), _mm_set_ps( 3.5f, 2.5f, 1.5f, 0.5f ) );
+
+		for ( int y = y0; y <= y1; y++ )
+		{
+			__m128 py = _mm_set1_ps( y + 0.5f );
+			__m128 r[5];
+			for ( int e = 0; e < 5; e++ )
+				r[e] = _mm_add_ps( _mm_mul_ps( b[e], py ), c[e] );
+			__m128 rz = _mm_add_ps( _mm_mul_ps( zb, py ), zc );
+
+			float* row = &depth[y * width];
+			__m128 px  = start;
+			for ( int x = x0; x <= p.maxX; x += 4, px = _mm_add_ps( px, four ) )
+			{
+				__m128 inside = _mm_cmpge_ps( _mm_add_ps( _mm_mul_ps( a[0], px ), r[0] ), zero );
+				for ( int e = 1; e < 5; e++ )
+					inside = _mm_and_ps( inside, _mm_cmpge_ps( _mm_add_ps( _mm_mul_ps( a[e], px ), r[e] ), zero ) );
+
+				if ( !_mm_movemask_ps( inside ) )
+					continue;
+
+				__m128 z   = _mm_add_ps( _mm_mul_ps( za, px ), rz );
+				__m128 old = _mm_loadu_ps( row + x );
+				__m128 out = _mm_max_ps( old, z );
+				_mm_storeu_ps( row + x, _mm_or_ps( _mm_and_ps( inside, out ), _mm_andnot_ps( inside, old ) ) );
+			}
+		}
+#else
+		for ( int y = y0; y <= y1; y++ )
+		{
+			float py = y + 0.5f;
+			float* row = &depth[y * width];
+
+			for ( int x = p.minX; x <= p.maxX; x++ )
+			{
+				float px = x + 0.5f;
+
+				bool inside = true;
+				for ( int e = 0; e < 5; e++ )
+					inside &= p.edgeA[e] * px + p.edgeB[e] * py + p.edgeC[e] >= 0.0f;
+
+				if ( inside )
+					row[x] = std::max( row[x], p.depthA * px + p.depthB * py + p.depthC );
+			}
+		}
+#endif
+	}
+}
+
+
+/*!
+ * Draws every occluder added since begin(), a band of rows per thread.
+ */
+void OcclusionCuller::render( void )
+{
+	int bands = pool.getThreadCount();
+	int rows  = ( height + bands - 1 ) / bands;
+
+	for ( int top = 0; top < height; top += rows )
+	{
+		int bottom = std::min( top + rows, height );
+		pool.submit( [this, top, bottom]( void ) {
+			drawBand( top, bottom );
+		} );
+	}
+
+	pool.wait();
+}
+
+
+/*!
+ * Returns false if the box is hidden behind the occluders drawn. Boxes
+ * reaching within OC_NEAR of the eye, or wholly off screen, are visible.
+ */
+bool OcclusionCuller::test( glm::vec3 min, glm::vec3 max ) const
+{
+	glm::vec3 size = max - min;
+	glm::vec4 origin = viewProjection * glm::vec4( min, 1.0f );
+	glm::vec4 axes[3] = {
+		viewProjection[0] * size.x,
+		viewProjection[1] * size.y,
+		viewProjection[2] * size.z
+	};
+
+	float minX = FLT_MAX, maxX = -FLT_MAX;
+	float minY = FLT_MAX, maxY = -FLT_MAX;
+	float nearest = 0.0f;
+
+	for ( int i = 0; i < 8; i++ )
+	{
+		glm::vec4 p = origin;
+		if ( i & 1 ) p += axes[0];
+		if ( i & 2 ) p += axes[1];
+		if ( i & 4 ) p += axes[2];
+
+		if ( p.w < OC_NEAR )
+			return true;
+
+		float z = 1.0f / p.w;
+		float x = ( p.x * z * 0.5f + 0.5f ) * width;
+		float y = ( p.y * z * 0.5f + 0.5f ) * height;
+
+		minX = std::min( minX, x ); maxX = std::max( maxX, x );
+		minY = std::min( minY, y ); maxY = std::max( maxY, y );
+		nearest = std::max( nearest, z );
+	}
+
+	// Every pixel the box touches, even in part.
+	int x0 = std::max( (int) floorf( minX ), 0 );
+	int x1 = std::min( (int)  ceilf( maxX ), width );
+	int y0 = std::max( (int) floorf( minY ), 0 );
+	int y1 = std::min( (int)  ceilf( maxY ), height );
+
+	if ( x0 >= x1 || y0 >= y1 )
+		return true;
+
+#ifdef TRN_SIMD
+	// Whole groups of four, so a few pixels either side are tested too, which
+	// only makes the box more likely to be visible.
+	x0 &= ~3;
+	__m128 z = _mm_set1_ps( nearest );
+
+	for ( int y = y0; y < y1; y++ )
+	{
+		const float* row = &depth[y * width];
+		for ( int x = x0; x < x1; x += 4 )
+			if ( _mm_movemask_ps( _mm_cmplt_ps( _mm_loadu_ps( row + x ), z ) ) )
+				return true;
+	}
+#else
+	for ( int y = y0; y < y1; y++ )
+	{
+		const float* row = &depth[y * width];
+		for ( int x = x0; x < x1; x++ )
+			if ( row[x] < nearest )
+				return true;
+	}
+#endif
+
+	return false;
+}
+
+
+/*!
+ * Tests boxes first to last, exclusive, that are still visible, clearing
+ * visible[n] for those hidden. Returns the number hidden.
+ */
+int OcclusionCuller::cullRange( const BoxList& boxes, int first, int last, unsigned char* visible ) const
+{
+	int hidden = 0;
+
+	for ( int n = first; n < last; n++ )
+	{
+		if ( !visible[n] )
+			continue;
+
+		glm::vec3 c( boxes.cx[n], boxes.cy[n], boxes.cz[n] );
+		glm::vec3 e( boxes.ex[n], boxes.ey[n], boxes.ez[n] );
+		if ( !test( c - e, c + e ) )
+		{
+			visible[n] = 0;
+			hidden++;
+		}
+	}
+
+	return hidden;
+}
+
+
+/*!
+ * Tests every box still marked visible, as left by Frustum::cull, against
+ * the occluders drawn, a run of boxes per thread. Clears visible[n] for those
+ * hidden and returns how many were.
+ */
+int OcclusionCuller::cull( const BoxList& boxes, unsigned char* visible )
+{
+	int jobs  = (int) rejected.size();
+	int count = boxes.size();
+	int run   = ( count + jobs - 1 ) / jobs;
+
+	for ( int j = 0; j < jobs; j++ )
+	{
+		int first = std::min( j * run, count );
+		int last  = std::min( first + run, count );
+		pool.submit( [this, &boxes, first, last, visible, j]( void ) {
+			rejected[j] = cullRange( boxes, first, last, visible );
+		} );
+	}
+
+	pool.wait();
+
+	int hidden = 0;
+	for ( int r : rejected )
+		hidden += r;
+
+	return hidden;
+}
+
+
+/*!
+ * Returns the number of occluders added since begin() not wholly clipped
+ * away.
+ */
+int OcclusionCuller::getOccluders( void ) const
+{
+	return occluders;
+}
+
+
+int OcclusionCuller::getWidth( void ) const
+{
+	return width;
+}
+
+
+int OcclusionCuller::getHeight( void ) const
+{
+	return height;
+}
+
+
+/*!
+ * Returns the depth buffer, a row at a time from the bottom of the screen,
+ * holding 1 / w of the nearest occluder or zero.
+ */
+const float* OcclusionCuller::getDepth( void ) const
+{
+	return &depth[0];
+}
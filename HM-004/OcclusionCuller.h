@@ -0,0 +1,75 @@
+#pragma once
+
+
+#include "MacroTerrain.h"
+#include "ThreadPool.h"
+
+
+struct BoxList;
+
+
+/*!
+ * Software occlusion culling. Occluders, quads known to be fully opaque, are
+ * drawn on the CPU into a small depth buffer, and boxes are then tested
+ * against it: a box is hidden if every pixel it covers holds an occluder
+ * nearer than the box's nearest corner.
+ *
+ * The buffer holds 1 / w, which is linear across an occluder on screen, so
+ * larger is nearer and empty pixels are zero. Occluders are clipped a block
+ * in front of the eye and drawn whole, as convex polygons rather than pairs
+ * of triangles. They cover only the pixels they cover entirely, and write
+ * each with the farthest value they take anywhere in it, pushed slightly
+ * farther still. So an occluder only ever hides what lies wholly behind it,
+ * even at its edges, and never a box whose own face it is. The price is that
+ * the pixels along the seam between two neighbouring occluders are covered
+ * by neither.
+ *
+ * Drawing is split into bands of rows, and testing into runs of boxes, each
+ * a job on the culler's own thread pool. Both work on four pixels at a time
+ * when built with TRN_SIMD.
+ */
+class OcclusionCuller {
+private:
+	// A convex polygon set up for drawing: an edge function per side, up to
+	// the five a quad clipped by one plane can have, and the plane of its
+	// depth, all in pixels, and its bounds on screen. Unused edges are zero,
+	// and so inside everywhere.
+	struct Polygon {
+		float edgeA[5], edgeB[5], edgeC[5];
+		float depthA, depthB, depthC;
+		int minX, maxX, minY, maxY;
+	};
+
+	int width;
+	int height;
+	std::vector<float> depth;
+
+	glm::mat4 viewProjection;
+	std::vector<Polygon> polygons;
+	int occluders;
+
+	ThreadPool pool;
+
+	// Boxes hidden by each job of the last cull().
+	std::vector<int> rejected;
+
+	void addPolygon( const glm::vec4* clip, int count );
+	void drawBand( int top, int bottom );
+	int  cullRange( const BoxList& boxes, int first, int last, unsigned char* visible ) const;
+
+public:
+	OcclusionCuller( int width = TRN_OCCLUSION_WIDTH, int height = TRN_OCCLUSION_HEIGHT, int threads = TRN_OCCLUSION_THREADS );
+
+	void begin( const glm::mat4& viewProjection );
+	void addOccluder( const glm::vec3 corners[4] );
+	void addSolidFaces( glm::vec3 origin, float size, unsigned char faces );
+	void render( void );
+
+	bool test( glm::vec3 min, glm::vec3 max ) const;
+	int  cull( const BoxList& boxes, unsigned char* visible );
+
+	int getOccluders( void ) const;
+	int getWidth( void ) const;
+	int getHeight( void ) const;
+	const float* getDepth( void ) const;
+};
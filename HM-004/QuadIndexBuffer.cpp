@@ -0,0 +1,97 @@
+#include "Base.h"
+#include "QuadIndexBuffer.h"
+
+#include "GLState.h"
+#include "VAO.h"
+
+
+// Quads indexable with 16 bits.
+#define QIB_SHORT_QUADS 16384
+
+
+GLuint QuadIndexBuffer::ID    = 0;
+GLenum QuadIndexBuffer::type  = GL_UNSIGNED_SHORT;
+int    QuadIndexBuffer::quads = 0;
+
+
+/*!
+ * Fills a vector with the triangle list indices of count quads.
+ */
+template <typename T>
+static void fill( std::vector<T>* indices, int count )
+{
+	indices->resize( count * 6 );
+
+	for ( int q = 0; q < count; q++ )
+	{
+		T v = (T) ( q * 4 );
+		T* i = &( *indices )[q * 6];
+		i[0] = v;
+		i[1] = v + 1;
+		i[2] = v + 2;
+		i[3] = v;
+		i[4] = v + 2;
+		i[5] = v + 3;
+	}
+}
+
+
+/*!
+ * Makes sure the buffer covers meshes of the given number of quads. The
+ * first call generates the whole 16 bit range at once, so it is only ever
+ * regenerated, as 32 bit, for a mesh of over 16384 quads. Unbinds any vertex
+ * array, so call it before binding the one to attach the buffer to.
+ */
+void QuadIndexBuffer::reserve( int quads )
+{
+	if ( ID && quads <= QuadIndexBuffer::quads )
+		return;
+
+	if ( !ID )
+		glGenBuffers( 1, &ID );
+
+	VAO::unbind();
+	GLState::bindBuffer( GL_ELEMENT_ARRAY_BUFFER, ID );
+
+	if ( quads <= QIB_SHORT_QUADS )
+	{
+		std::vector<GLushort> indices;
+		fill( &indices, QIB_SHORT_QUADS );
+		glBufferData( GL_ELEMENT_ARRAY_BUFFER, sizeof ( GLushort ) * indices.size(), &indices[0], GL_STATIC_DRAW );
+
+		type = GL_UNSIGNED_SHORT;
+		QuadIndexBuffer::quads = QIB_SHORT_QUADS;
+	} else
+	{
+		int count = std::max( quads, QuadIndexBuffer::quads * 2 );
+
+		std::vector<GLuint> indices;
+		fill( &indices, count );
+		glBufferData( GL_ELEMENT_ARRAY_BUFFER, sizeof ( GLuint ) * indices.size(), &indices[0], GL_STATIC_DRAW );
+
+		type = GL_UNSIGNED_INT;
+		QuadIndexBuffer::quads = count;
+	}
+
+	GLState::bindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+}
+
+
+/*!
+ * Binds the buffer as the element array of the bound vertex array.
+ */
+void QuadIndexBuffer::bind( void )
+{
+	GLState::bindBuffer( GL_ELEMENT_ARRAY_BUFFER, ID );
+}
+
+
+/*!
+ * Returns the index type to draw with, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+ * Read it at draw time, as the buffer may have widened since the mesh was
+ * uploaded.
+ */
+GLenum QuadIndexBuffer::getType( void )
+{
+	return type;
+}
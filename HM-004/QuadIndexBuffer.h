@@ -0,0 +1,21 @@
+#pragma once
+
+
+/*!
+ * One index buffer shared by every terrain mesh drawn as plain quads. Quad n
+ * is the triangles (4n, 4n+1, 4n+2) and (4n, 4n+2, 4n+3), so any mesh whose
+ * vertices come in fours can be drawn as a triangle list without indices of
+ * its own. Indices are 16 bit while every mesh fits in 65536 vertices, and
+ * widen to 32 bit only if a larger one is uploaded.
+ */
+class QuadIndexBuffer {
+private:
+	static GLuint ID;
+	static GLenum type;
+	static int    quads;
+
+public:
+	static void   reserve( int quads );
+	static void   bind( void );
+	static GLenum getType( void );
+};
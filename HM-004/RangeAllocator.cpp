@@ -0,0 +1,122 @@
+#include "Base.h"
+#include "RangeAllocator.h"
+
+
+/*!
+ * Creates an allocator with the whole space free.
+ */
+RangeAllocator::RangeAllocator( int capacity ) :
+	capacity( 0 ),
+	used( 0 )
+{
+	reset( capacity, 0 );
+}
+
+
+/*!
+ * Returns the offset of a newly allocated range of the given size, or -1 if
+ * no free range is large enough.
+ */
+int RangeAllocator::allocate( int size )
+{
+	for ( auto itr = freeRanges.begin(); itr != freeRanges.end(); itr++ )
+	{
+		if ( itr->second < size )
+			continue;
+
+		int offset = itr->first;
+		int left   = itr->second - size;
+
+		freeRanges.erase( itr );
+		if ( left > 0 )
+			freeRanges[offset + size] = left;
+
+		used += size;
+		return offset;
+	}
+
+	return -1;
+}
+
+
+/*!
+ * Returns a range to the free list, merging it with the free ranges either
+ * side of it.
+ */
+void RangeAllocator::release( int offset, int size )
+{
+	used -= size;
+
+	auto next = freeRanges.lower_bound( offset );
+	if ( next != freeRanges.end() && next->first == offset + size )
+	{
+		size += next->second;
+		next = freeRanges.erase( next );
+	}
+
+	if ( next != freeRanges.begin() )
+	{
+		auto prev = next;
+		prev--;
+		if ( prev->first + prev->second == offset )
+		{
+			prev->second += size;
+			return;
+		}
+	}
+
+	freeRanges[offset] = size;
+}
+
+
+/*!
+ * Resizes the space, taking the first used elements as allocated and the
+ * rest as free, as after the owner has packed every range to the front.
+ */
+void RangeAllocator::reset( int capacity, int used )
+{
+	this->capacity = capacity;
+	this->used     = used;
+
+	freeRanges.clear();
+	if ( used < capacity )
+		freeRanges[used] = capacity - used;
+}
+
+
+/*!
+ * Returns the size of the whole space.
+ */
+int RangeAllocator::getCapacity( void ) const
+{
+	return capacity;
+}
+
+
+/*!
+ * Returns the number of elements allocated.
+ */
+int RangeAllocator::getUsed( void ) const
+{
+	return used;
+}
+
+
+/*!
+ * Returns the number of free elements lying between allocated ranges, that
+ * is, free space not counting the run at the end.
+ */
+int RangeAllocator::getHoles( void ) const
+{
+	int holes = capacity - used;
+
+	if ( !freeRanges.empty() )
+	{
+		auto last = freeRanges.end();
+		last--;
+		if ( last->first + last->second == capacity )
+			holes -= last->second;
+	}
+
+	return holes;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+
+/*!
+ * Hands out ranges of a fixed-size space, such as the elements of a GPU
+ * buffer, from a free list kept sorted by offset. Allocation takes the first
+ * range that fits; released ranges merge with free neighbours. It only does
+ * the bookkeeping: moving the contents when the space grows or is compacted
+ * is up to the owner.
+ */
+class RangeAllocator {
+private:
+	// Free ranges, offset to size.
+	std::map<int, int> freeRanges;
+	int capacity;
+	int used;
+
+public:
+	RangeAllocator( int capacity );
+
+	int  allocate( int size );
+	void release( int offset, int size );
+	void reset( int capacity, int used );
+
+	int getCapacity( void ) const;
+	int getUsed( void ) const;
+	int getHoles( void ) const;
+};
@@ -0,0 +1,84 @@
+#include "Base.h"
+#include "RenderQueue.h"
+
+
+/*!
+ * Empties the queue, keeping its storage.
+ */
+void RenderQueue::clear( void )
+{
+	items.clear();
+}
+
+
+/*!
+ * Sorts the items by key, least significant byte first. All eight byte
+ * histograms are counted in one pass over the keys, and a byte every key
+ * shares, as pass, shader and texture mostly are, is skipped outright, so a
+ * frame of terrain costs three or four passes rather than eight. The sort is
+ * stable.
+ */
+void RenderQueue::sort( void )
+{
+	int n = (int) items.size();
+	if ( n < 2 )
+		return;
+
+	static const int BYTES = 8;
+
+	int counts[BYTES][256];
+	memset( counts, 0, sizeof ( counts ) );
+
+	for ( int i = 0; i < n; i++ )
+	{
+		unsigned long long key = items[i].key;
+		for ( int b = 0; b < BYTES; b++ )
+			counts[b][( key >> ( b * 8 ) ) & 0xff]++;
+	}
+
+	scratch.resize( n );
+	RenderItem* from = &items[0];
+	RenderItem* to   = &scratch[0];
+
+	for ( int b = 0; b < BYTES; b++ )
+	{
+		int* count = counts[b];
+
+		if ( count[( from[0].key >> ( b * 8 ) ) & 0xff] == n )
+			continue;
+
+		int offset = 0;
+		for ( int d = 0; d < 256; d++ )
+		{
+			int c = count[d];
+			count[d] = offset;
+			offset += c;
+		}
+
+		for ( int i = 0; i < n; i++ )
+			to[count[( from[i].key >> ( b * 8 ) ) & 0xff]++] = from[i];
+
+		std::swap( from, to );
+	}
+
+	if ( from != &items[0] )
+		items.swap( scratch );
+}
+
+
+/*!
+ * Returns the number of items queued.
+ */
+int RenderQueue::size( void ) const
+{
+	return (int) items.size();
+}
+
+
+/*!
+ * Returns the i-th item; in key order once sorted.
+ */
+const RenderItem& RenderQueue::operator[]( int i ) const
+{
+	return items[i];
+}
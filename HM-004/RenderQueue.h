@@ -0,0 +1,70 @@
+#pragma once
+
+
+enum RenderPass {
+	PASS_OPAQUE = 0,
+	PASS_TRANSPARENT,
+	PASS_GUI
+};
+
+
+struct RenderItem {
+	unsigned long long key;
+	int index;
+};
+
+
+/*!
+ * The draws of a frame, each an index into the caller's own list paired with
+ * a 64 bit sort key, radix sorted so that draws sharing state run together.
+ * The key packs, from the most significant bits down:
+ *
+ *   pass (4) | shader (12) | texture (12) | depth (24) | spare (12)
+ *
+ * Depth sorts opaque draws front to back, so that nearer geometry fills the
+ * depth buffer first and hidden fragments are rejected before shading, and
+ * transparent draws back to front.
+ */
+class RenderQueue {
+private:
+	std::vector<RenderItem> items;
+	std::vector<RenderItem> scratch;
+
+public:
+	static unsigned long long makeKey( RenderPass pass, unsigned int shader, unsigned int texture, float depth );
+
+	void clear( void );
+	void push( unsigned long long key, int index );
+	void sort( void );
+
+	int size( void ) const;
+	const RenderItem& operator[]( int i ) const;
+};
+
+
+/*!
+ * Packs a sort key. Depth is a distance from the eye, zero or more; as the
+ * bits of a non-negative float order the same way as its value, the top 24
+ * bits serve as the quantised depth with no range to choose.
+ */
+inline unsigned long long RenderQueue::makeKey( RenderPass pass, unsigned int shader, unsigned int texture, float depth )
+{
+	unsigned int bits;
+	memcpy( &bits, &depth, sizeof ( bits ) );
+
+	unsigned long long d = bits >> 8;
+	if ( pass == PASS_TRANSPARENT )
+		d = 0xffffff - d;
+
+	return (unsigned long long) pass          << 60
+		 | (unsigned long long) ( shader  & 0xfff ) << 48
+		 | (unsigned long long) ( texture & 0xfff ) << 36
+		 | d << 12;
+}
+
+
+inline void RenderQueue::push( unsigned long long key, int index )
+{
+	RenderItem item = { key, index };
+	items.push_back( item );
+}
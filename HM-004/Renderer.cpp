@@ -10,11 +10,22 @@
 #include "Camera.h"
 #include "Shader.h"
 #include "FBO.h"
+#include "FrameUniforms.h"
+#include "GLState.h"
 #include "Texture.h"
 #include "Mesh.h"
 
 #include "Entity.h"
 #include "Chunk.h"
+#include "Clock.h"
+#include "Frustum.h"
+#include "MeshQueue.h"
+#include "OcclusionCuller.h"
+#include "RenderQueue.h"
+#include "Terrain.h"
+#include "TerrainArena.h"
+#include "TerrainMesh.h"
+#include "VAO.h"
 #include "GUIElement.h"
 #include "Input.h"
 
@@ -31,13 +42,36 @@
  */
 Renderer::Renderer( GLFWwindow* window ) :
 	window( window ),
-	entities( new std::map<int, LerpMesh*>() ),
-	 terrain( new std::map<int,     Mesh*>() ),
-	     gui( new std::map<int,     Mesh*>() ),
+	entities( new std::map<int,    LerpMesh*>() ),
+	 terrain( new std::map<int, TerrainMesh*>() ),
+	     gui( new std::map<int,        Mesh*>() ),
+	meshQueue( new MeshQueue() ),
+	arena( new TerrainArena() ),
+	terrainList( new std::vector<TerrainMesh*>() ),
+	terrainDraw( new std::vector<TerrainMesh*>() ),
+	terrainBounds( new BoxList() ),
+	terrainVisible( new std::vector<unsigned char>() ),
+	terrainChanged( false ),
+	terrainQueue( new RenderQueue() ),
+	sortTerrain( true ),
+	overdrawFrame( 0 ),
+	overdrawSamples( 1 ),
+	frustum( new Frustum() ),
+	occlusion( new OcclusionCuller() ),
+	cullOccluded( true ),
 	 shaderCache( new ResourceCache<Shader>()  ),
 	textureCache( new ResourceCache<Texture>() ),
 	textureTerrain( textureCache->getResource( "texture/block.tex" ) )
 {
+	stats.chunksDrawn    = 0;
+	stats.chunksCulled   = 0;
+	stats.drawCalls      = 0;
+	stats.chunksOccluded = 0;
+	stats.occluders      = 0;
+	stats.occlusionTime  = 0.0;
+	stats.overdraw       = 0.0f;
+	stats.stateChanges   = 0;
+	stats.stateSkipped   = 0;
 }
 
 
@@ -62,19 +96,19 @@ void Renderer::setup( void )
  */
 void Renderer::setupOpenGL( void )
 {
-	glEnable( GL_TEXTURE_2D );
+	GLState::enable( GL_TEXTURE_2D );
 	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
 
-	glEnable( GL_PRIMITIVE_RESTART );
+	GLState::enable( GL_PRIMITIVE_RESTART );
 	glPrimitiveRestartIndex( 0xffffffff );
 
-	glEnable( GL_DEPTH_TEST );
+	GLState::enable( GL_DEPTH_TEST );
 	glDepthFunc( GL_LEQUAL );
 
-	glEnable( GL_CULL_FACE );
+	GLState::enable( GL_CULL_FACE );
 	glCullFace( GL_BACK );
 
-	glEnable( GL_BLEND );
+	GLState::enable( GL_BLEND );
 	glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
 
 	glMatrixMode( GL_PROJECTION );
@@ -83,6 +117,13 @@ void Renderer::setupOpenGL( void )
 	glMatrixMode( GL_MODELVIEW );
 
 	glViewport( 0, 0, WIN_W, WIN_H );
+
+	glGenQueries( 2, overdrawQueries );
+
+	// WIN_FSAA is only a request; ask what the window got. Without
+	// multisampling this is zero, and each pixel is one sample.
+	glGetIntegerv( GL_SAMPLES, &overdrawSamples );
+	overdrawSamples = std::max( overdrawSamples, 1 );
 }
 
 
@@ -106,6 +147,9 @@ void Renderer::setupFontStash( void )
 {
 	stash = glfonsCreate( 512, 512, FONS_ZERO_BOTTOMLEFT );
 	consola = fonsAddFont( stash, "consola", "font/ConsolaMono.ttf" );
+
+	// Creating the atlas bound it with plain GL calls.
+	GLState::invalidate();
 }
 
 
@@ -166,6 +210,33 @@ void Renderer::setupDebug( void )
 {
 	torus = Mesh::createTorus( glm::vec3( 0.0 ), glm::vec3( 10.0, 10.0, 10.0 ), 8, 1, 4 );
 	Core::getInput()->add( "display_lines", { GLFW_KEY_F1 } );
+	Core::getInput()->add( "sort_terrain",  { GLFW_KEY_F2 } );
+	Core::getInput()->add( "occlusion",     { GLFW_KEY_F3 } );
+}
+
+
+/*!
+ * Draws the last frame's counts in the top left corner.
+ */
+void Renderer::renderStats( void )
+{
+	std::ostringstream chunks, hidden, state;
+	chunks << "chunks: " << stats.chunksDrawn  << " drawn, "   << stats.chunksCulled << " culled, "
+	       << stats.drawCalls << " draw calls, " << std::fixed << std::setprecision( 2 )
+	       << stats.overdraw << " overdraw" << ( sortTerrain ? "" : " (unsorted)" );
+	state  << "state: "  << stats.stateChanges << " changes, " << stats.stateSkipped << " skipped";
+
+	if ( cullOccluded )
+		hidden << "occlusion: " << stats.chunksOccluded << " hidden, " << stats.occluders << " occluders, "
+		       << std::setprecision( 2 ) << stats.occlusionTime * 1000.0 << " ms";
+	else
+		hidden << "occlusion: off";
+
+	GLState::disable( GL_DEPTH_TEST );
+	renderString( chunks.str(), 16.0f, glm::vec2( 4, WIN_H - 16 ) );
+	renderString( hidden.str(), 16.0f, glm::vec2( 4, WIN_H - 32 ) );
+	renderString(  state.str(), 16.0f, glm::vec2( 4, WIN_H - 48 ) );
+	GLState::enable( GL_DEPTH_TEST );
 }
 
 
@@ -182,6 +253,12 @@ void Renderer::runDebug( double alpha, Camera* camera )
 	{
 		glPolygonMode( GL_FRONT, GL_FILL );
 	}
+
+	if ( Core::getInput()->pressed( "sort_terrain" ) )
+		sortTerrain = !sortTerrain;
+
+	if ( Core::getInput()->pressed( "occlusion" ) )
+		cullOccluded = !cullOccluded;
 }
 #endif
 
@@ -194,14 +271,16 @@ void Renderer::render( double alpha, Camera* camera )
 #ifdef DEBUG_MODE
 	runDebug( alpha, camera );
 #endif
+
+	stats.stateChanges = GLState::getStats().changes;
+	stats.stateSkipped = GLState::getStats().skipped;
+	GLState::resetStats();
+
+	uploadTerrain( WIN_UPLOAD_BUDGET / 1000.0 );
 	
 	glClearColor( 0.529f, 0.808f, 0.922f, 1.0f );
 
-	// Send projection matrices.
-	if ( shaderTerrain->usesProjection() )
-	{
-		shaderTerrain->sendProjection( camera->getMatrices()->getProjection() );
-	}
+	uploadFrame( camera->getMatrices() );
 //	if ( shaderEntity->usesProjection() )
 //	{
 //		shaderTerrain->sendProjection( camera->getMatrices()->getProjection() );
@@ -217,7 +296,7 @@ void Renderer::render( double alpha, Camera* camera )
 //	shadowMap->bind();
 //
 //	glClear( GL_DEPTH_BUFFER_BIT );
-//	glDisable( GL_CULL_FACE );
+//	GLState::disable( GL_CULL_FACE );
 	
 //	renderTerrain(         shaderShadow, shadowMatrices );
 //	renderEntities( alpha, shaderShadow, shadowMatrices );
@@ -228,17 +307,46 @@ void Renderer::render( double alpha, Camera* camera )
 //	shadowMap->bindTexture();
 
 	glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
-	glEnable( GL_CULL_FACE );
+	GLState::enable( GL_CULL_FACE );
 
 	textureTerrain->bind();
 	renderTerrain(         shaderTerrain, camera->getMatrices(), shadowMatrices );
 	renderEntities( alpha, shaderEntity,  camera->getMatrices(), shadowMatrices );
 	renderGUI(             shaderGUI,     camera->getMatrices() );
 
+#ifdef DEBUG_MODE
+	renderStats();
+#endif
+
 //	FBO::unbindTexture();
 }
 
 
+/*!
+ * Uploads the constants shared by every draw this frame to the Frame
+ * uniform block: the camera's view and projection, the normal matrix and the
+ * light in view space. Terrain is drawn untranslated, so the normal matrix
+ * is that of the view alone and is inverted once here rather than per chunk.
+ */
+void Renderer::uploadFrame( Matrices* mat )
+{
+	mat->loadIdentity();
+
+	FrameData frame;
+	frame.view       = mat->getView();
+	frame.projection = mat->getProjection();
+
+	glm::mat3 normal = mat->getNormal();
+	for ( int i = 0; i < 3; i++ )
+		frame.normal[i] = glm::vec4( normal[i], 0.0f );
+
+	frame.lightDir   = glm::vec4( glm::normalize( glm::mat3( frame.view ) * lightDir ), 0.0f );
+	frame.lightColor = glm::vec4( lightColor, 1.0f );
+
+	FrameUniforms::update( frame );
+}
+
+
 #ifdef DEBUG_MODE
 /*!
  * Draw a torus to the back buffer, for debugging purposes.
@@ -279,6 +387,7 @@ void Renderer::renderTorus( Shader* shader, Matrices* mat, Matrices* shadowMat )
 
 	torus->draw();
 
+	VAO::unbind();
 	Shader::unbind();
 }
 #endif
@@ -302,44 +411,129 @@ void Renderer::renderTerrain( Shader* shader, Matrices* mat, Matrices* shadowMat
 {
 	shader->bind();
 
-	// Send directional light data.
-	if ( shader->usesLightDir() )
-	{
-		shader->sendLightDir( glm::normalize( glm::mat3( mat->getView() ) * lightDir ) );
-		shader->sendLightColor( lightColor );
-	}
-
-	// Render chunks.
-	for ( auto itr = terrain->begin(); itr != terrain->end(); itr++ )
+	// Shaders reading the Frame block already have the view, projection and
+	// light for this frame. Others, such as a shadow pass, get them as plain
+	// uniforms. Either way chunks are placed by their offsets in the arena,
+	// so every chunk shares the one untranslated modelview.
+	if ( !shader->usesFrame() )
 	{
-		Mesh* m = itr->second;
+		if ( shader->usesLightDir() )
+		{
+			shader->sendLightDir( glm::normalize( glm::mat3( mat->getView() ) * lightDir ) );
+			shader->sendLightColor( lightColor );
+		}
 
-		// Reset the model matrix.
 		mat->loadIdentity();
 
-		// Only translation is required for terrain.
-		mat->translate( m->getPosition() );
-
-		// Send the precomputed modelview and normal (inverse-
-		// transpose modelview) matrices to GPU.
 		if ( shader->usesModelView() )
 			shader->sendModelView( mat->getModelView() );
 
 		if ( shader->usesNormal() )
 			shader->sendNormal( mat->getNormal() );
 
-		// Compute and send the shadow matrices if needed.
 		if ( shadowMat != 0 &&
 			 shader->usesShadowMatrices() )
 		{
 			shadowMat->loadIdentity();
-			shadowMat->translate( m->getPosition() );
 			shader->sendShadowModelView( shadowMat->getModelView() );
 		}
+	}
+
+	// Flatten the map and its bounds for culling, only when it has changed.
+	if ( terrainChanged )
+	{
+		terrainList->clear();
+		terrainBounds->clear();
+		for ( auto itr = terrain->begin(); itr != terrain->end(); itr++ )
+		{
+			terrainList->push_back( itr->second );
+			terrainBounds->add( itr->second->getMin(), itr->second->getMax() );
+		}
+
+		terrainVisible->resize( terrainList->size() );
+		terrainChanged = false;
+	}
+
+	// Skip chunks outside the view, then those hidden behind the solid faces
+	// of the chunks left, then render the rest.
+	glm::mat4 viewProjection = mat->getProjection() * mat->getView();
+	frustum->extract( viewProjection );
+	int drawn = terrainList->empty() ? 0 : frustum->cull( *terrainBounds, &( *terrainVisible )[0] );
+
+	stats.chunksOccluded = 0;
+	stats.occluders      = 0;
+	stats.occlusionTime  = 0.0;
+
+	if ( cullOccluded && drawn > 0 )
+	{
+		double start = Clock::now();
+
+		occlusion->begin( viewProjection );
+		for ( size_t n = 0; n < terrainList->size(); n++ )
+		{
+			if ( !( *terrainVisible )[n] )
+				continue;
+
+			TerrainMesh* m = ( *terrainList )[n];
+			occlusion->addSolidFaces( glm::vec3( m->getOffset() ), (float) TRN_CHUNK_SIZE, m->getSolidFaces() );
+		}
+		occlusion->render();
+
+		stats.chunksOccluded = occlusion->cull( *terrainBounds, &( *terrainVisible )[0] );
+		stats.occluders      = occlusion->getOccluders();
+		stats.occlusionTime  = Clock::now() - start;
+		drawn -= stats.chunksOccluded;
+	}
 
-		m->draw();
+	// Order the visible chunks front to back, by the distance from the eye to
+	// the nearest point of each box, so that early depth testing rejects as
+	// much of what lies behind as it can.
+	glm::mat4 view = mat->getView();
+	glm::vec3 eye  = -( glm::transpose( glm::mat3( view ) ) * glm::vec3( view[3] ) );
+
+	terrainQueue->clear();
+	for ( size_t n = 0; n < terrainList->size(); n++ )
+	{
+		if ( !( *terrainVisible )[n] )
+			continue;
+
+		TerrainMesh* m = ( *terrainList )[n];
+		float depth = sortTerrain ? glm::length( glm::clamp( eye, m->getMin(), m->getMax() ) - eye ) : 0.0f;
+
+		terrainQueue->push( RenderQueue::makeKey( PASS_OPAQUE, shader->getID(), textureTerrain->getID(), depth ), (int) n );
+	}
+	terrainQueue->sort();
+
+	terrainDraw->clear();
+	for ( int i = 0; i < terrainQueue->size(); i++ )
+		terrainDraw->push_back( ( *terrainList )[( *terrainQueue )[i].index] );
+
+	// Count the fragments drawn, reading back last frame's count if the GPU
+	// has it, so as not to wait.
+	GLuint query = overdrawQueries[overdrawFrame & 1];
+	GLuint last  = overdrawQueries[( overdrawFrame + 1 ) & 1];
+	GLuint ready = 0;
+	if ( overdrawFrame > 0 )
+		glGetQueryObjectuiv( last, GL_QUERY_RESULT_AVAILABLE, &ready );
+
+	if ( ready )
+	{
+		GLuint samples;
+		glGetQueryObjectuiv( last, GL_QUERY_RESULT, &samples );
+		stats.overdraw = (float) samples / ( WIN_W * WIN_H * overdrawSamples );
 	}
 
+	glBeginQuery( GL_SAMPLES_PASSED, query );
+	int calls = arena->draw( *terrainDraw );
+	glEndQuery( GL_SAMPLES_PASSED );
+	overdrawFrame++;
+
+	VAO::unbind();
+
+	stats.chunksDrawn  = drawn;
+	stats.chunksCulled = (int) terrainList->size() - drawn - stats.chunksOccluded;
+	stats.drawCalls    = calls;
+
 	Shader::unbind();
 }
 
@@ -360,7 +554,7 @@ void Renderer::renderProgress( std::string name, float progress, glm::vec4 color
 {
 	renderString( name, 24.0f, glm::vec2( 4, 21 ) );
 
-	glDisable( GL_TEXTURE_2D );
+	GLState::disable( GL_TEXTURE_2D );
 	glBegin( GL_QUADS );
 	{
 		glColor4f( color.r, color.g, color.b, color.a );
@@ -370,7 +564,7 @@ void Renderer::renderProgress( std::string name, float progress, glm::vec4 color
 		glVertex2f( 0, 15 );
 	}
 	glEnd();
-	glEnable( GL_TEXTURE_2D );
+	GLState::enable( GL_TEXTURE_2D );
 }
 
 
@@ -379,7 +573,10 @@ void Renderer::renderProgress( std::string name, float progress, glm::vec4 color
  */
 void Renderer::renderString( std::string text, float size, glm::vec2 pos, glm::vec3 color, float blur )
 {
-	glDisable( GL_TEXTURE_2D );
+	GLState::disable( GL_TEXTURE_2D );
+
+	// Fontstash binds its atlas on the active unit with plain GL calls.
+	GLState::activeTexture( 0 );
 
 	fonsSetFont(  stash, consola );
 	fonsSetSize(  stash, size );
@@ -391,8 +588,9 @@ void Renderer::renderString( std::string text, float size, glm::vec2 pos, glm::v
 	) );
 	fonsSetBlur(  stash, blur );
 	fonsDrawText( stash, pos.x, pos.y, text.c_str(), 0 );
+	GLState::invalidate();
 
-	glEnable( GL_TEXTURE_2D );
+	GLState::enable( GL_TEXTURE_2D );
 }
 
 
@@ -411,16 +609,93 @@ void Renderer::addEntity( Entity* entity )
 
 
 /*!
- * Add a terrain section to be rendererd.
+ * Add a terrain section to be rendered. If its blocks have changed it is
+ * queued for meshing on a worker thread, and appears once uploadTerrain()
+ * reaches it; otherwise its current mesh, if any, is drawn straight away.
  */
 void Renderer::addTerrain( Chunk* chunk )
 {
-	terrain->insert(
-		std::pair<int, Mesh*>(
-			chunk->getID(),
-			chunk->getMesh()
-		)
-	);
+	if ( chunk->isChanged() )
+	{
+		meshQueue->submit( chunk );
+		return;
+	}
+
+	TerrainMesh* mesh = chunk->getMesh();
+
+	if ( !mesh )
+		return;
+
+	( *terrain )[chunk->getID()] = mesh;
+	terrainChanged = true;
+}
+
+
+/*!
+ * Adds every chunk of the terrain. Meshing happens on worker threads, so
+ * this returns at once and chunks appear over the following frames. Each
+ * chunk's mesh takes a slot in the arena, so a world of more chunks than it
+ * has slots is refused here, before any is uploaded.
+ * TODO: store terrain for auto adding future chunks.
+ */
+void Renderer::addTerrain( Terrain* terrain )
+{
+	if ( terrain->getChunks().size() > TA_SLOTS )
+		throw std::runtime_error( "Terrain has more chunks than the renderer has mesh slots (TA_SLOTS)." );
+
+	for ( auto& c : terrain->getChunks() )
+		addTerrain( c.chunk );
+}
+
+
+/*!
+ * Uploads meshed chunks until the budget, in seconds, is spent, replacing
+ * any older meshes of the same chunks. At least one chunk is uploaded if any
+ * are ready, so a small budget still makes progress. Returns the number of
+ * chunks uploaded.
+ */
+int Renderer::uploadTerrain( double budget )
+{
+	double start = Clock::now();
+	int uploaded = 0;
+
+	Chunk* chunk;
+	MeshData* data;
+	while ( ( !uploaded || Clock::now() - start < budget ) && meshQueue->pop( &chunk, &data ) )
+	{
+		// Free the old mesh's slot first, so a chunk only ever holds one.
+		delete chunk->getMesh();
+
+		TerrainMesh* mesh = data->vertices.empty() ? nullptr : new TerrainMesh( arena, data );
+		meshQueue->recycle( data );
+
+		chunk->setMesh( mesh );
+		if ( mesh )
+			( *terrain )[chunk->getID()] = mesh;
+		else
+			terrain->erase( chunk->getID() );
+
+		uploaded++;
+	}
+
+	// Replaced meshes leave holes in the arena; pack them once per batch.
+	if ( uploaded )
+	{
+		arena->compact();
+		terrainChanged = true;
+	}
+
+	return uploaded;
+}
+
+
+/*!
+ * Drops chunks still waiting to be meshed and waits for those in progress.
+ * Call before editing or deleting terrain that has been added.
+ */
+void Renderer::stopMeshing( void )
+{
+	meshQueue->cancel();
 }
 
 
@@ -445,3 +720,12 @@ Shader* Renderer::getShader( std::string url )
 {
 	return shaderCache->getResource( url );
 }
+
+
+/*!
+ * Returns the counts from the last frame drawn.
+ */
+const RenderStats& Renderer::getStats( void ) const
+{
+	return stats;
+}
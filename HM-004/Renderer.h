@@ -6,24 +6,91 @@ class ResourceCache;
 
 class Matrices;
 class Camera;
+class Frustum;
 class Shader;
 class ShadowMap;
 class Texture;
 
-class     Mesh;
-class LerpMesh;
+class        Mesh;
+class    LerpMesh;
+class TerrainMesh;
 
 class Entity;
 class Chunk;
+class Terrain;
+class MeshQueue;
+class OcclusionCuller;
+class RenderQueue;
+class TerrainArena;
 class GUIElement;
 
+struct BoxList;
+
+
+/*!
+ * Counts from the last frame drawn.
+ */
+struct RenderStats {
+	int chunksDrawn;
+	int chunksCulled;
+	int drawCalls;
+
+	// Chunks in view hidden behind others, the chunk faces drawn as
+	// occluders to find them, and the seconds it took.
+	int    chunksOccluded;
+	int    occluders;
+	double occlusionTime;
+
+	// Terrain fragments that passed the depth test, per pixel of the window,
+	// from the latest frame the GPU has finished.
+	float overdraw;
+
+	// GL state changes issued and skipped as redundant, over the whole of
+	// the frame before.
+	int stateChanges;
+	int stateSkipped;
+};
+
 
 class Renderer {
 private:
 	// Meshes for rendering.
-	std::map<int, LerpMesh*>* entities;
-	std::map<int,     Mesh*>* terrain;
-	std::map<int,     Mesh*>* gui;
+	std::map<int,    LerpMesh*>* entities;
+	std::map<int, TerrainMesh*>* terrain;
+	std::map<int,        Mesh*>* gui;
+
+	// Chunks being meshed on worker threads, uploaded a few per frame.
+	MeshQueue* meshQueue;
+
+	// Buffers holding every terrain mesh.
+	TerrainArena* arena;
+
+	// Terrain meshes in draw order with their bounds, rebuilt from the map
+	// when it changes, which of them passed the last cull, and those drawn.
+	std::vector<TerrainMesh*>*  terrainList;
+	std::vector<TerrainMesh*>*  terrainDraw;
+	BoxList*                    terrainBounds;
+	std::vector<unsigned char>* terrainVisible;
+	bool terrainChanged;
+
+	// Visible terrain ordered front to back, unless turned off to compare.
+	RenderQueue* terrainQueue;
+	bool sortTerrain;
+
+	// Samples passed queries around the terrain draw, alternating frames so
+	// that the one read is a frame old, and the samples the window has per
+	// pixel, which they count each of.
+	GLuint overdrawQueries[2];
+	int    overdrawFrame;
+	int    overdrawSamples;
+
+	Frustum* frustum;
+
+	// Hides chunks behind the solid faces of nearer ones, unless turned off.
+	OcclusionCuller* occlusion;
+	bool cullOccluded;
+
+	RenderStats stats;
 
 	// Resource caches.
 	ResourceCache<Shader>*   shaderCache;
@@ -55,12 +122,15 @@ private:
 	void setupLighting( void );
 	void setupFontStash( void );
 
+	void uploadFrame( Matrices* mat );
+
 	// Debug.
 #ifdef DEBUG_MODE
 	Mesh* torus;
 
 	void setupDebug( void );
 	void runDebug( double alpha, Camera* camera );
+	void renderStats( void );
 	void renderTorus(
 		Shader* shader,
 		Matrices* mat,
@@ -104,13 +174,19 @@ public:
 
 	void  addEntity( Entity* entity   );
 	void addTerrain( Chunk* chunk     );
+	void addTerrain( Terrain* terrain );
 	void     addGUI( GUIElement* gui  );
 
+	int  uploadTerrain( double budget );
+	void  stopMeshing( void );
+
 	void  removeEntity( int id );
 	void removeTerrain( int id );
 	void     removeGUI( int id );
 
 	Shader* getShader( std::string url );
 
+	const RenderStats& getStats( void ) const;
+
 	GLFWwindow* const window;
 };
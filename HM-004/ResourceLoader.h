@@ -18,7 +18,7 @@ public:
 template <typename T>
 inline T* ResourceLoader<T>::load( std::string url )
 {
-	throw std::exception( "Invalid resource type." );
+	throw std::runtime_error( "Invalid resource type." );
 
 	return 0;
 }
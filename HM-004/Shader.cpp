@@ -2,12 +2,8 @@
 #include "Shader.h"
 
 #include "File.h"
-
-
-/*!
- * Stores the ID of the currently bound shader.
- */
-GLuint Shader::bound = 0;
+#include "FrameUniforms.h"
+#include "GLState.h"
 
 
 /*!
@@ -56,7 +52,7 @@ Shader::Shader( std::string name, std::string vert_src, std::string frag_src ) :
 
 		glDeleteProgram( ID );
 
-		throw std::exception( "Shader compilation failed." );
+		throw std::runtime_error( "Shader compilation failed." );
 	}
 
 	// Compile fragment shader.
@@ -68,7 +64,7 @@ Shader::Shader( std::string name, std::string vert_src, std::string frag_src ) :
 
 		glDeleteProgram( ID );
 
-		throw std::exception( "Shader compilation failed." );
+		throw std::runtime_error( "Shader compilation failed." );
 	}
 
 	// Attach shaders to program, and link program.
@@ -94,18 +90,21 @@ Shader::Shader( std::string name, std::string vert_src, std::string frag_src ) :
 	// Setup uniforms.
 	bind();
 	{
-		uniformLoc_M          = glGetUniformLocation( ID, "u_M"          );
-		uniformLoc_MV         = glGetUniformLocation( ID, "u_MV"         );
-		uniformLoc_P          = glGetUniformLocation( ID, "u_P"          );
-		uniformLoc_N          = glGetUniformLocation( ID, "u_N"          );
-		uniformLoc_lightDir   = glGetUniformLocation( ID, "u_lightDir"   );
-		uniformLoc_lightColor = glGetUniformLocation( ID, "u_lightColor" );
-		uniformLoc_sMV        = glGetUniformLocation( ID, "u_sMV"        );
-		uniformLoc_sP         = glGetUniformLocation( ID, "u_sP"         );
+		uniformLoc_M           = glGetUniformLocation( ID, "u_M"           );
+		uniformLoc_MV          = glGetUniformLocation( ID, "u_MV"          );
+		uniformLoc_P           = glGetUniformLocation( ID, "u_P"           );
+		uniformLoc_N           = glGetUniformLocation( ID, "u_N"           );
+		uniformLoc_lightDir    = glGetUniformLocation( ID, "u_lightDir"    );
+		uniformLoc_lightColor  = glGetUniformLocation( ID, "u_lightColor"  );
+		uniformLoc_sMV         = glGetUniformLocation( ID, "u_sMV"         );
+		uniformLoc_sP          = glGetUniformLocation( ID, "u_sP"          );
+
+		frame = FrameUniforms::attach( ID );
 		
 		GLuint sampler_2D       = glGetUniformLocation( ID, "u_2D"       );
 		GLuint sampler_2DArray  = glGetUniformLocation( ID, "u_2DArray"  );
 		GLuint sampler_2DShadow = glGetUniformLocation( ID, "u_2DShadow" );
+		GLuint sampler_iBuffer  = glGetUniformLocation( ID, "u_iBuffer"  );
 
 		if ( sampler_2D != -1 )
 			glUniform1i( sampler_2D, 0 );
@@ -114,6 +113,9 @@ Shader::Shader( std::string name, std::string vert_src, std::string frag_src ) :
 
 		if ( sampler_2DShadow != -1 )
 			glUniform1i( sampler_2DShadow, 1 );
+
+		if ( sampler_iBuffer != -1 )
+			glUniform1i( sampler_iBuffer, 2 );
 	}
 	unbind();
 
@@ -128,7 +130,7 @@ void Shader::bind( void )
 {
 	if ( compiled )
 	{
-		glUseProgram( bound = ID );
+		GLState::useProgram( ID );
 	}
 }
 
@@ -138,7 +140,7 @@ void Shader::bind( void )
  */
 void Shader::unbind( void )
 {
-	glUseProgram( bound = 0 );
+	GLState::useProgram( 0 );
 }
 
 
@@ -147,7 +149,7 @@ void Shader::unbind( void )
  */
 bool Shader::isBound( void )
 {
-	return bound == ID;
+	return GLState::getProgram() == ID;
 }
 
 
@@ -291,6 +293,17 @@ void Shader::sendShadowProjection( glm::mat4 sp )
 }
 
 
+/*!
+ * Returns true if this shader reads the per-frame constants from the Frame
+ * uniform block, rather than from the individual uniforms above.
+ */
+bool Shader::usesFrame( void )
+{
+	return frame;
+}
+
+
+
 /*!
  * Returns true if the shader has successfully compiled.
  */
@@ -300,6 +313,15 @@ bool Shader::isCompiled( void )
 }
 
 
+/*!
+ * Returns the GL name of the program.
+ */
+GLuint Shader::getID( void ) const
+{
+	return ID;
+}
+
+
 /*!
  * Loads a shader from an xml file.
  */
@@ -310,7 +332,7 @@ Shader* ResourceLoader<Shader>::load( std::string url )
 
 	if ( !result )
 	{
-		throw std::exception( (
+		throw std::runtime_error( (
 			"Failed to parse shader xml file at \"" + url + "\".\n" +
 			result.description() + "."
 		).c_str() );
@@ -328,7 +350,7 @@ Shader* ResourceLoader<Shader>::load( std::string url )
 
 	if ( vert.empty() || frag.empty() )
 	{
-		throw std::exception( (
+		throw std::runtime_error( (
 			"Failed to read one or more shader sources for \"" + name + "\".\n"
 		).c_str() );
 	}
@@ -13,11 +13,11 @@ class ResourceLoader;
 
 class Shader {
 private:
-	static GLuint bound;
-	       GLuint ID;
+	GLuint ID;
 	  std::string name;
 
 	bool compiled;
+	bool frame;
 
 	GLint uniformLoc_MV,
 		  uniformLoc_M,
@@ -57,7 +57,11 @@ public:
 	void  sendShadowModelView( glm::mat4 smv );
 	void sendShadowProjection( glm::mat4 sp );
 
+	bool usesFrame( void );
+
 	bool isCompiled( void );
+
+	GLuint getID( void ) const;
 };
 
 
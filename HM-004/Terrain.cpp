@@ -1,16 +1,28 @@
 #include "Base.h"
 #include "Terrain.h"
 
-#include "Renderer.h"
 #include "Chunk.h"
+#include "ColumnData.h"
+#include "GenStages.h"
+#include "LoadProgress.h"
+#include "ThreadPool.h"
 
 
-Terrain::Terrain( void ) :
-	csize( 16 ),
-	width( 18 ),
-	height( 8 ),
-	depth( 18 ),
+/*!
+ * Generates the island described by params on the given number of threads,
+ * or one per hardware thread if zero. Touches neither GL nor the window, so
+ * may run on any thread. With progress set each pass is reported through it,
+ * and if it is cancelled generation stops early, leaving the terrain empty.
+ */
+Terrain::Terrain( const WorldGenParams& params, int threads, LoadProgress* progress ) :
+	params( params ),
+	csize( TRN_CHUNK_SIZE ),
+	width( params.width ),
+	height( params.height ),
+	depth( params.depth ),
 	total( width * height * depth ),
+	threads( threads ),
+	progress( progress ),
 	blockTypes( new BlockType[256] ),
 	blockEmpty( new Block() )
 {
@@ -23,92 +35,117 @@ Terrain::Terrain( void ) :
 }
 
 
+/*!
+ * Generates the island through a fused pipeline of stages (hills, caves,
+ * sealing). Columns of chunks are set up first, one job each, then every
+ * chunk is built in a single job and traversal. Jobs only ever write to their
+ * own chunks or columns and read nothing but noise and column data, so the
+ * result is the same whatever the number of threads.
+ */
 void Terrain::generateIsland( void )
 {
-	int count = 0;
-	for ( int i = 0; i < width; i++ )
-	for ( int j = 0; j < height; j++ )
-	for ( int k = 0; k < depth; k++ )
-	{
-		chunks[glm::ivec3( i, j, k )] = new Chunk( glm::ivec3( i, j, k ), csize, this );
+	ThreadPool pool( threads );
 
-		// Stop the window from becoming unresponsive.
-		Core::cheapProgress( "Generating hills...", (float) count++ / total );
-	}
+	GenPipeline pipeline( csize );
+	pipeline.add( new HillStage( params ) );
+	pipeline.add( new CaveStage( params ) );
+	pipeline.add( new SealStage( params ) );
 
-	count = 0;
-	for ( int i = 0; i < width; i++ )
-	for ( int j = 0; j < height; j++ )
-	for ( int k = 0; k < depth; k++ )
+#ifdef DEBUG_MODE
+	pipeline.setTiming( true );
+#endif
+
+	// Columns. Values depending only on (x, z), shared by each stack of chunks.
+	std::vector<ColumnData> columns( width * depth, ColumnData( csize ) );
+	bool complete = runPass( &pool, "Shaping the island...", width * depth, [&]( int n )
 	{
-		for ( int x = 0; x < csize; x++ )
-		for ( int y = 0; y < csize; y++ )
-		for ( int z = 0; z < csize; z++ )
-		{
-			Block& b = chunks[glm::ivec3( i, j, k )]->getBlockAt( x, y, z );
-			int ix = ( csize * i + x );
-			int jy = ( csize * j + y );
-			int kz = ( csize * k + z );
+		pipeline.generateColumn( n / depth, n % depth, &columns[n] );
+	} );
+
+	if ( !complete )
+		return;
 
-			if ( glm::simplex( glm::vec3( ix / 30.0, jy / 30.0, kz / 30.0 ) ) - jy / 96.0 > 0 )
-				b.id = 0;
-		}
+	// Chunks are built in parallel, then indexed on this thread.
+	std::vector<Chunk*> built( total, nullptr );
+	complete = runPass( &pool, "Generating terrain...", total, [&]( int n )
+	{
+		glm::ivec3 pos( n / ( height * depth ), n / depth % height, n % depth );
+		built[n] = new Chunk( pos, csize, this );
+		pipeline.generateChunk( built[n], columns[pos.x * depth + pos.z] );
+	} );
 
-		// Stop the window from becoming unresponsive.
-		Core::cheapProgress( "Generating caves...", (float) count++ / total );
+	if ( !complete )
+	{
+		for ( auto c : built )
+			delete c;
+		return;
 	}
 
-	for ( int i = 0; i < width; i++ )
-	for ( int k = 0; k < depth; k++ )
+	for ( int n = 0; n < total; n++ )
+		chunks.insert( built[n]->getPosition(), built[n] );
+
+#ifdef DEBUG_MODE
+	pipeline.printTimings();
+#endif
+}
+
+
+/*!
+ * Runs one job per index in [0, jobs) on the pool and waits for them all,
+ * reporting each as it completes. Returns false if the load was cancelled,
+ * in which case any jobs not yet started are skipped.
+ */
+bool Terrain::runPass( ThreadPool* pool, const char* name, int jobs, std::function<void( int )> job )
+{
+	if ( progress )
+		progress->begin( name, jobs );
+
+	LoadProgress* report = progress;
+	for ( int n = 0; n < jobs; n++ )
 	{
-		for ( int x = 0; x < csize; x++ )
-		for ( int z = 0; z < csize; z++ )
+		pool->submit( [&job, report, n]
 		{
-			int ix = ( csize * i + x );
-			int kz = ( csize * k + z );
-			int height = (int) ( ( glm::simplex( glm::vec2( ix / 90.0, kz / 90.0 ) ) + 1 ) * 4 + 1 );
-			for ( int y = 0; y < height; y++ )
-				chunks[glm::ivec3( i, 0, k )]->getBlockAt( x, y, z ).id = 1;
-		}
-			
-		// Stop the window from becoming unresponsive.
-		Core::cheapProgress( "Sealing in the goodness...", (float) count++ / ( width * depth ) );
+			if ( report && report->isCancelled() )
+				return;
+
+			job( n );
+
+			if ( report )
+				report->advance();
+		} );
 	}
+
+	pool->wait();
+
+	return !progress || !progress->isCancelled();
 }
 
 
 Terrain::~Terrain( void )
 {
-	for ( auto c : chunks )
-		delete c.second;
+	for ( auto& c : chunks )
+		delete c.chunk;
 
 	delete blockEmpty;
 }
 
 
 /*!
- * Adds the meshes for all current chunks to the renderer.
- * TODO: store renderer for auto adding future chunks.
+ * Returns every chunk, keyed by chunk coordinates.
  */
-void Terrain::addToRenderer( Renderer* renderer )
+const ChunkMap& Terrain::getChunks( void ) const
 {
-	int count = 0;
-	for ( auto c : chunks )
-	{
-		renderer->addTerrain( c.second );
-
-		// Stop the window from becoming unresponsive while large batches are meshed.
-		Core::cheapProgress( "Meshing chunks...", (float) count++ / total );
-	}
+	return chunks;
 }
 
 
 /*!
- * Returns the chunk at the specificed position from the map.
+ * Returns the chunk at the specificed position from the map, or null if
+ * there is no chunk there.
  */
 Chunk* Terrain::getChunkAt( glm::ivec3 pos )
 {
-	return chunks[pos];
+	return chunks.find( pos );
 }
 
 
@@ -118,17 +155,59 @@ Chunk* Terrain::getChunkAt( glm::ivec3 pos )
 Block Terrain::getBlockAt( glm::ivec3 pos )
 {
 	glm::ivec3 cpos = glm::ivec3( glm::floor( glm::vec3( pos ) / (float) csize ) );
-	if ( chunks.find( cpos ) != chunks.end() )
-		return chunks[cpos]->getBlockAt( pos % csize );
+	Chunk* c = chunks.find( cpos );
+	if ( c )
+		return c->getBlockAt( pos % csize );
 	else
 		return *blockEmpty;
 }
 
 
+/*!
+ * Returns the params the terrain was generated from.
+ */
+const WorldGenParams& Terrain::getParams( void ) const
+{
+	return params;
+}
+
+
+/*!
+ * Returns a 64 bit hash of every block in the world: an FNV-1a hash of each
+ * chunk's hash, in [x][y][z] chunk order. Equal params must always give equal
+ * hashes; if not, compare Chunk::getHash() to find the chunks that differ.
+ */
+unsigned long long Terrain::getHash( void )
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	for ( int x = 0; x < width;  x++ )
+	for ( int y = 0; y < height; y++ )
+	for ( int z = 0; z < depth;  z++ )
+	{
+		Chunk* c = chunks.find( glm::ivec3( x, y, z ) );
+		unsigned long long h = c ? c->getHash() : 0;
+
+		for ( int i = 0; i < 8; i++ )
+			hash = ( hash ^ ( ( h >> ( i * 8 ) ) & 0xFF ) ) * 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+
 /*!
  * Returns the block type definition object for a given block id.
  */
 const BlockType Terrain::getBlockTypeFromId( char id )
 {
-	return blockTypes[id];
+	return blockTypes[(unsigned char) id];
+}
+
+
+/*!
+ * Returns the table of block type definitions, indexed by block id.
+ */
+const BlockType* Terrain::getBlockTypes( void ) const
+{
+	return blockTypes;
 }
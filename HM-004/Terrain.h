@@ -1,11 +1,17 @@
 #pragma once
 
 
+#include "MacroTerrain.h"
+#include "ChunkMap.h"
+#include "WorldGenParams.h"
+
+
 class Chunk;
-class Renderer;
+class ThreadPool;
+class LoadProgress;
 struct Block;
 
-static enum Face {
+enum Face {
 	RIGHT = 0,
 	LEFT,
 	BOTTOM,
@@ -15,43 +21,45 @@ static enum Face {
 };
 
 
+/*!
+ * A block's texture array layer for each face, by Face. Layers are packed
+ * into eight bits of each vertex, so must be below 256.
+ */
 struct BlockType {
 	int textures[6];
 };
 
 
-class ivec3_compare {
-public:
-	bool operator()( glm::ivec3 const& l, glm::ivec3 const& r )
-	{
-		return l.x  < r.x ||
-			   l.x == r.x && l.y  < r.y ||
-			   l.x == r.x && l.y == r.y && l.z < r.z;
-	};
-};
-
-
 class Terrain {
 private:
-	std::map<glm::ivec3, Chunk*, ivec3_compare> chunks;
+	ChunkMap chunks;
+	WorldGenParams params;
 	int csize;
 	int width, height, depth, total;
 
+	int threads;
+	LoadProgress* progress;
+
 	BlockType* blockTypes;
 
 	Block* blockEmpty;
 
 public:
-	Terrain( void );
+	Terrain( const WorldGenParams& params = WorldGenParams(), int threads = TRN_GEN_THREADS, LoadProgress* progress = nullptr );
 	~Terrain( void );
 
 	void generateIsland( void );
+	bool runPass( ThreadPool* pool, const char* name, int jobs, std::function<void( int )> job );
 	void loadBlockTypes( std::string path );
 
-	void addToRenderer( Renderer* renderer );
+	const ChunkMap& getChunks( void ) const;
 
 	Chunk* getChunkAt( glm::ivec3 pos );
 	Block  getBlockAt( glm::ivec3 pos );
 
-	const BlockType getBlockTypeFromId( char id );
+	const WorldGenParams& getParams( void ) const;
+	unsigned long long    getHash( void );
+
+	const BlockType  getBlockTypeFromId( char id );
+	const BlockType* getBlockTypes( void ) const;
 };
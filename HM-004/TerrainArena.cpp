@@ -0,0 +1,387 @@
+#include "Base.h"
+#include "TerrainArena.h"
+
+#include "GLState.h"
+#include "QuadIndexBuffer.h"
+#include "TerrainMesh.h"
+#include "VAO.h"
+
+
+/*!
+ * Returns the capacity to repack a space to so that size more elements fit:
+ * its current capacity if that leaves room once the holes are squeezed out,
+ * otherwise at least double.
+ */
+static int fit( const RangeAllocator& ranges, int size )
+{
+	int capacity = ranges.getCapacity();
+
+	if ( capacity - ranges.getUsed() >= size )
+		return capacity;
+
+	return std::max( capacity * 2, ranges.getUsed() + size );
+}
+
+
+/*!
+ * Creates the buffers, empty, with room for the given number of vertices,
+ * and the buffer texture of chunk offsets.
+ */
+TerrainArena::TerrainArena( int vertices ) :
+	vertexID( 0 ),
+	indexID( 0 ),
+	vao( new VAO() ),
+	vertexRanges( vertices ),
+#ifdef TRN_QUAD_INDICES
+	indexRanges( 0 ),
+#else
+	indexRanges( vertices / 4 * 5 ),
+#endif
+	entries( TA_SLOTS ),
+	moves( 0 )
+{
+#ifdef TRN_QUAD_INDICES
+	mode = GL_TRIANGLES;
+#else
+	mode = GL_TRIANGLE_FAN;
+#endif
+
+	Entry empty = { 0, 0, 0, 0 };
+	std::fill( entries.begin(), entries.end(), empty );
+
+	for ( int s = TA_SLOTS - 1; s >= 0; s-- )
+		freeSlots.push_back( s );
+
+	glGenBuffers( 1, &vertexID );
+	GLState::bindBuffer( GL_COPY_WRITE_BUFFER, vertexID );
+	glBufferData( GL_COPY_WRITE_BUFFER, sizeof ( TerrainVertex ) * vertices, 0, GL_STATIC_DRAW );
+
+#ifdef TRN_QUAD_INDICES
+	QuadIndexBuffer::reserve( 0 );
+#else
+	glGenBuffers( 1, &indexID );
+	GLState::bindBuffer( GL_COPY_WRITE_BUFFER, indexID );
+	glBufferData( GL_COPY_WRITE_BUFFER, sizeof ( GLuint ) * indexRanges.getCapacity(), 0, GL_STATIC_DRAW );
+#endif
+
+	// One ivec4 per slot: the chunk's origin, and padding.
+	glGenBuffers( 1, &offsetID );
+	GLState::bindBuffer( GL_TEXTURE_BUFFER, offsetID );
+	glBufferData( GL_TEXTURE_BUFFER, sizeof ( GLint ) * 4 * TA_SLOTS, 0, GL_DYNAMIC_DRAW );
+
+	glGenTextures( 1, &offsetTexture );
+	GLState::bindTexture( 2, GL_TEXTURE_BUFFER, offsetTexture );
+	glTexBuffer( GL_TEXTURE_BUFFER, GL_RGBA32I, offsetID );
+
+	attach();
+}
+
+
+TerrainArena::~TerrainArena( void )
+{
+	GLState::deleteBuffer( vertexID );
+	if ( indexID )
+		GLState::deleteBuffer( indexID );
+	GLState::deleteBuffer( offsetID );
+	glDeleteTextures( 1, &offsetTexture );
+
+	delete vao;
+}
+
+
+/*!
+ * Points the vertex array at the current buffers. Both words of each vertex
+ * go to attribute 0 as integers, left for terrain.vert to unpack.
+ */
+void TerrainArena::attach( void )
+{
+	vao->bind();
+	{
+		GLState::bindBuffer( GL_ARRAY_BUFFER, vertexID );
+#ifdef TRN_QUAD_INDICES
+		QuadIndexBuffer::bind();
+#else
+		GLState::bindBuffer( GL_ELEMENT_ARRAY_BUFFER, indexID );
+#endif
+
+		glEnableVertexAttribArray( 0 );
+		glVertexAttribIPointer(
+			0,
+			2,
+			GL_UNSIGNED_INT,
+			sizeof ( TerrainVertex ),
+			(GLvoid*) 0
+		);
+	}
+	vao->unbind();
+}
+
+
+/*!
+ * Moves every mesh, in buffer order, to the front of new buffers of the
+ * given capacities, on the GPU, then frees the old buffers. This both grows
+ * the arena and squeezes out the holes left by removed meshes. Slots, and so
+ * the vertices themselves, are unchanged. A mesh part way through add(),
+ * its indices not yet allocated, has only its vertices moved.
+ */
+void TerrainArena::repack( int vertexCapacity, int indexCapacity )
+{
+	std::vector<int> order;
+	for ( int s = 0; s < TA_SLOTS; s++ )
+		if ( entries[s].vertices )
+			order.push_back( s );
+
+	std::sort( order.begin(), order.end(), [this]( int a, int b ) {
+		return entries[a].first < entries[b].first;
+	} );
+
+	GLuint newID;
+	glGenBuffers( 1, &newID );
+	GLState::bindBuffer( GL_COPY_WRITE_BUFFER, newID );
+	glBufferData( GL_COPY_WRITE_BUFFER, sizeof ( TerrainVertex ) * vertexCapacity, 0, GL_STATIC_DRAW );
+	GLState::bindBuffer( GL_COPY_READ_BUFFER, vertexID );
+
+	int at = 0;
+	for ( int s : order )
+	{
+		Entry& e = entries[s];
+		if ( e.first != at )
+			moves++;
+
+		glCopyBufferSubData(
+			GL_COPY_READ_BUFFER,
+			GL_COPY_WRITE_BUFFER,
+			sizeof ( TerrainVertex ) * e.first,
+			sizeof ( TerrainVertex ) * at,
+			sizeof ( TerrainVertex ) * e.vertices
+		);
+		e.first = at;
+		at += e.vertices;
+	}
+
+	GLState::deleteBuffer( vertexID );
+	vertexID = newID;
+	vertexRanges.reset( vertexCapacity, at );
+
+#ifndef TRN_QUAD_INDICES
+	std::sort( order.begin(), order.end(), [this]( int a, int b ) {
+		return entries[a].indexFirst < entries[b].indexFirst;
+	} );
+
+	glGenBuffers( 1, &newID );
+	GLState::bindBuffer( GL_COPY_WRITE_BUFFER, newID );
+	glBufferData( GL_COPY_WRITE_BUFFER, sizeof ( GLuint ) * indexCapacity, 0, GL_STATIC_DRAW );
+	GLState::bindBuffer( GL_COPY_READ_BUFFER, indexID );
+
+	at = 0;
+	for ( int s : order )
+	{
+		Entry& e = entries[s];
+		if ( e.indexFirst < 0 )
+			continue;
+
+		glCopyBufferSubData(
+			GL_COPY_READ_BUFFER,
+			GL_COPY_WRITE_BUFFER,
+			sizeof ( GLuint ) * e.indexFirst,
+			sizeof ( GLuint ) * at,
+			sizeof ( GLuint ) * e.indices
+		);
+		e.indexFirst = at;
+		at += e.indices;
+	}
+
+	GLState::deleteBuffer( indexID );
+	indexID = newID;
+	indexRanges.reset( indexCapacity, at );
+#else
+	(void) indexCapacity;
+#endif
+
+	attach();
+}
+
+
+/*!
+ * Uploads a mesh, which must have vertices, returning the slot it is drawn
+ * by. Its vertices are stamped with the slot in place, so the data must not
+ * be uploaded twice. A slot must be free: there are enough for one mesh per
+ * chunk so long as a chunk's old mesh is removed before its new one is added.
+ */
+int TerrainArena::add( MeshData* data )
+{
+	assert( !freeSlots.empty() );
+
+	int slot = freeSlots.back();
+	freeSlots.pop_back();
+
+	int vertices = (int) data->vertices.size();
+#ifndef TRN_QUAD_INDICES
+	int indices  = (int) data->indices.size();
+#endif
+
+	// Allocate the vertices first, as the slot's entry, so that repacking for
+	// the indices moves them along with everything else.
+	Entry& e = entries[slot];
+	e.first = vertexRanges.allocate( vertices );
+	if ( e.first < 0 )
+	{
+		repack( fit( vertexRanges, vertices ), indexRanges.getCapacity() );
+		e.first = vertexRanges.allocate( vertices );
+	}
+	e.vertices = vertices;
+
+#ifdef TRN_QUAD_INDICES
+	QuadIndexBuffer::reserve( vertices / 4 );
+	e.indexFirst = 0;
+	e.indices    = vertices / 4 * 6;
+#else
+	e.indexFirst = indexRanges.allocate( indices );
+	if ( e.indexFirst < 0 )
+	{
+		repack( vertexRanges.getCapacity(), fit( indexRanges, indices ) );
+		e.indexFirst = indexRanges.allocate( indices );
+	}
+	e.indices = indices;
+#endif
+
+	for ( auto& v : data->vertices )
+	{
+		v.a |= (GLuint) ( slot >> 12 ) << 21;
+		v.b |= (GLuint) ( slot & 4095 ) << 20;
+	}
+
+	GLState::bindBuffer( GL_COPY_WRITE_BUFFER, vertexID );
+	glBufferSubData(
+		GL_COPY_WRITE_BUFFER,
+		sizeof ( TerrainVertex ) * e.first,
+		sizeof ( TerrainVertex ) * vertices,
+		&data->vertices[0]
+	);
+
+#ifndef TRN_QUAD_INDICES
+	GLState::bindBuffer( GL_COPY_WRITE_BUFFER, indexID );
+	glBufferSubData(
+		GL_COPY_WRITE_BUFFER,
+		sizeof ( GLuint ) * e.indexFirst,
+		sizeof ( GLuint ) * indices,
+		&data->indices[0]
+	);
+#endif
+
+	GLint offset[4] = { data->offset.x, data->offset.y, data->offset.z, 0 };
+	GLState::bindBuffer( GL_TEXTURE_BUFFER, offsetID );
+	glBufferSubData( GL_TEXTURE_BUFFER, sizeof ( offset ) * slot, sizeof ( offset ), offset );
+
+	return slot;
+}
+
+
+/*!
+ * Frees a mesh's ranges and slot. The space is reused by later meshes, or
+ * reclaimed by compact().
+ */
+void TerrainArena::remove( int slot )
+{
+	Entry& e = entries[slot];
+
+	vertexRanges.release( e.first, e.vertices );
+#ifndef TRN_QUAD_INDICES
+	indexRanges.release( e.indexFirst, e.indices );
+#endif
+
+	e.vertices = 0;
+	e.indices  = 0;
+
+	freeSlots.push_back( slot );
+}
+
+
+/*!
+ * Draws a single mesh, leaving the arena's vertex array bound.
+ */
+void TerrainArena::draw( int slot )
+{
+	const Entry& e = entries[slot];
+
+	vao->bind();
+	GLState::bindTexture( 2, GL_TEXTURE_BUFFER, offsetTexture );
+
+#ifdef TRN_QUAD_INDICES
+	glDrawElementsBaseVertex( mode, e.indices, QuadIndexBuffer::getType(), (GLvoid*) 0, e.first );
+#else
+	glDrawElementsBaseVertex( mode, e.indices, GL_UNSIGNED_INT, (GLvoid*) ( sizeof ( GLuint ) * e.indexFirst ), e.first );
+#endif
+}
+
+
+/*!
+ * Draws the given meshes, in order, with one multi-draw call, leaving the
+ * arena's vertex array bound. Returns the number of draw calls made.
+ */
+int TerrainArena::draw( const std::vector<TerrainMesh*>& meshes )
+{
+	if ( meshes.empty() )
+		return 0;
+
+	counts.clear();
+	starts.clear();
+	bases.clear();
+
+	for ( auto m : meshes )
+	{
+		const Entry& e = entries[m->getSlot()];
+
+		counts.push_back( e.indices );
+		starts.push_back( (GLvoid*) ( sizeof ( GLuint ) * e.indexFirst ) );
+		bases.push_back( e.first );
+	}
+
+	vao->bind();
+	GLState::bindTexture( 2, GL_TEXTURE_BUFFER, offsetTexture );
+
+#ifdef TRN_QUAD_INDICES
+	GLenum type = QuadIndexBuffer::getType();
+#else
+	GLenum type = GL_UNSIGNED_INT;
+#endif
+
+	glMultiDrawElementsBaseVertex( mode, &counts[0], type, &starts[0], (GLsizei) counts.size(), &bases[0] );
+
+	return 1;
+}
+
+
+/*!
+ * Repacks the arena if removed meshes have left more than TRN_ARENA_DEFRAG
+ * of either buffer in holes between the live ones. Call after a batch of
+ * meshes has been replaced.
+ */
+void TerrainArena::compact( void )
+{
+	if ( vertexRanges.getHoles() > vertexRanges.getCapacity() * TRN_ARENA_DEFRAG
+	  || indexRanges.getHoles()  >  indexRanges.getCapacity() * TRN_ARENA_DEFRAG )
+	{
+		repack( vertexRanges.getCapacity(), indexRanges.getCapacity() );
+	}
+}
+
+
+/*!
+ * Returns the number of meshes moved by repacking so far.
+ */
+int TerrainArena::getMoves( void ) const
+{
+	return moves;
+}
+
+
+/*!
+ * Returns the number of bytes allocated on the GPU for the buffers.
+ */
+size_t TerrainArena::getMemoryUsage( void ) const
+{
+	return sizeof ( TerrainVertex ) * vertexRanges.getCapacity()
+		 + sizeof ( GLuint ) * indexRanges.getCapacity()
+		 + sizeof ( GLint ) * 4 * TA_SLOTS;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+
+#include "MacroTerrain.h"
+#include "RangeAllocator.h"
+
+
+class VAO;
+class TerrainMesh;
+
+struct MeshData;
+
+
+// Meshes the arena can hold at once, set by the sixteen slot bits of a
+// TerrainVertex, and the texels GL 4.0 guarantees a buffer texture.
+#define TA_SLOTS 65536
+
+
+/*!
+ * Holds every terrain mesh in one vertex buffer, and with TRN_QUAD_INDICES
+ * off one index buffer, suballocated by RangeAllocator and drawn through a
+ * single vertex array. Each mesh takes a slot, stamped into its vertices,
+ * which terrain.vert uses to look up the chunk offset in a buffer texture.
+ * Nothing is then set per chunk, so any list of meshes is drawn with one
+ * glMultiDrawElementsBaseVertex. There are TA_SLOTS slots, which the renderer
+ * checks a world fits in before uploading any of it.
+ *
+ * The buffers grow when full, and are packed again when freed ranges leave
+ * too much space in holes; see compact().
+ */
+class TerrainArena {
+private:
+	struct Entry {
+		int first, vertices;
+		int indexFirst, indices;
+	};
+
+	GLuint vertexID;
+	GLuint indexID;
+	GLuint offsetID;
+	GLuint offsetTexture;
+	GLenum mode;
+
+	VAO* vao;
+
+	RangeAllocator vertexRanges;
+	RangeAllocator indexRanges;
+
+	std::vector<Entry> entries;
+	std::vector<int>   freeSlots;
+
+	// Multi-draw arguments, reused every frame.
+	std::vector<GLsizei> counts;
+	std::vector<GLvoid*> starts;
+	std::vector<GLint>   bases;
+
+	int moves;
+
+	void attach( void );
+	void repack( int vertexCapacity, int indexCapacity );
+
+public:
+	TerrainArena( int vertices = TRN_ARENA_VERTICES );
+	~TerrainArena( void );
+
+	int  add( MeshData* data );
+	void remove( int slot );
+
+	void draw( int slot );
+	int  draw( const std::vector<TerrainMesh*>& meshes );
+
+	void compact( void );
+
+	int getMoves( void ) const;
+	size_t getMemoryUsage( void ) const;
+};
@@ -0,0 +1,81 @@
+#include "Base.h"
+#include "TerrainMesh.h"
+
+#include "TerrainArena.h"
+
+
+/*!
+ * Uploads the mesh to the arena. Its vertices are stamped with the slot it
+ * takes, so the data must not be uploaded again.
+ */
+TerrainMesh::TerrainMesh( TerrainArena* arena, MeshData* data ) :
+	arena( arena ),
+	slot( arena->add( data ) ),
+	offset( data->offset ),
+	min( data->offset + data->min ),
+	max( data->offset + data->max ),
+	solid( data->solid )
+{
+}
+
+
+TerrainMesh::~TerrainMesh( void )
+{
+	arena->remove( slot );
+}
+
+
+/*!
+ * Renders the mesh alone to the back buffer, leaving the arena's vertex
+ * array bound. The renderer draws many at once through TerrainArena::draw.
+ */
+void TerrainMesh::draw( void )
+{
+	arena->draw( slot );
+}
+
+
+/*!
+ * Returns the mesh's slot in the arena.
+ */
+int TerrainMesh::getSlot( void ) const
+{
+	return slot;
+}
+
+
+/*!
+ * Returns the absolute position of the chunk's origin.
+ */
+glm::ivec3 TerrainMesh::getOffset( void ) const
+{
+	return offset;
+}
+
+
+/*!
+ * Returns the minimum corner of the mesh's bounding box, in world space.
+ */
+glm::vec3 TerrainMesh::getMin( void ) const
+{
+	return min;
+}
+
+
+/*!
+ * Returns the maximum corner of the mesh's bounding box, in world space.
+ */
+glm::vec3 TerrainMesh::getMax( void ) const
+{
+	return max;
+}
+
+
+/*!
+ * Returns the chunk faces whose layer of blocks is entirely solid, one bit
+ * per normal. See Mesher::findSolidFaces.
+ */
+unsigned char TerrainMesh::getSolidFaces( void ) const
+{
+	return solid;
+}
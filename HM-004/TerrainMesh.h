@@ -0,0 +1,157 @@
+#pragma once
+
+
+#include "MacroTerrain.h"
+
+
+#if TRN_CHUNK_SIZE > 63
+#error "Packed terrain vertices hold chunks of up to 63 blocks."
+#endif
+
+
+class TerrainArena;
+
+
+/*!
+ * A terrain vertex packed into two words, a quarter of the size of a float
+ * vertex. Positions are local to the chunk, whose offset terrain.vert looks
+ * up by the mesh's TerrainArena slot, so the whole vertex is small integers:
+ *
+ *   a: x | y << 6 | z << 12 | normal << 18 | ( slot >> 12 ) << 21
+ *   b: s | t << 6 | layer << 12 | ( slot & 4095 ) << 20
+ *
+ * Normal is an index into +x, -x, +y, -y, +z, -z. The texture coordinates s
+ * and t run up to the quad's width and height, so textures tile across
+ * merged faces. Six bits per coordinate holds chunks of up to 63 blocks, and
+ * layer takes eight bits. The slot, of sixteen bits split across both words,
+ * is left zero by the mesher and stamped in on upload.
+ */
+struct TerrainVertex {
+	GLuint a, b;
+};
+
+
+/*!
+ * The CPU side of a terrain mesh: geometry built without touching GL, so it
+ * may be made on any thread and handed to the main thread to upload as a
+ * TerrainMesh. Offset is the absolute position of the chunk's origin, and
+ * min and max bound the vertices relative to it. Solid marks the chunk
+ * faces usable as occluders; see Mesher::findSolidFaces. With
+ * TRN_QUAD_INDICES the indices stay empty.
+ */
+struct MeshData {
+	std::vector<TerrainVertex> vertices;
+	std::vector<GLuint>        indices;
+	GLenum     mode;
+	glm::ivec3 offset;
+	glm::ivec3 min, max;
+	unsigned char solid;
+};
+
+
+/*!
+ * A chunk's uploaded geometry: a slot in the TerrainArena holding its packed
+ * vertices, and indices with TRN_QUAD_INDICES off. See terrain.vert for the
+ * decode.
+ */
+class TerrainMesh {
+private:
+	TerrainArena* arena;
+	int slot;
+
+	glm::ivec3 offset;
+	glm::vec3  min, max;
+	unsigned char solid;
+
+public:
+	TerrainMesh( TerrainArena* arena, MeshData* data );
+	~TerrainMesh( void );
+
+	void draw( void );
+
+	int getSlot( void ) const;
+
+	glm::ivec3 getOffset( void ) const;
+	glm::vec3  getMin( void ) const;
+	glm::vec3  getMax( void ) const;
+	unsigned char getSolidFaces( void ) const;
+
+	static void findBounds( MeshData* data );
+	static void appendQuad(
+		const glm::ivec3 corners[4],
+		int normal,
+		int w, int h,
+		int layer,
+		std::vector<TerrainVertex>* v,
+		std::vector<GLuint>* i
+	);
+};
+
+
+/*!
+ * Sets the data's min and max from the positions of its vertices, or to
+ * zero if it has none.
+ */
+inline void TerrainMesh::findBounds( MeshData* data )
+{
+	if ( data->vertices.empty() )
+	{
+		data->min = data->max = glm::ivec3( 0 );
+		return;
+	}
+
+	GLuint lo[3] = { 63, 63, 63 };
+	GLuint hi[3] = { 0, 0, 0 };
+	for ( auto& v : data->vertices )
+	{
+		for ( int k = 0; k < 3; k++ )
+		{
+			GLuint p = v.a >> ( k * 6 ) & 63;
+			lo[k] = std::min( lo[k], p );
+			hi[k] = std::max( hi[k], p );
+		}
+	}
+
+	data->min = glm::ivec3( lo[0], lo[1], lo[2] );
+	data->max = glm::ivec3( hi[0], hi[1], hi[2] );
+}
+
+
+/*!
+ * Appends the four packed corners of a chunk-local quad, in winding order,
+ * and, unless TRN_QUAD_INDICES is defined, its indices for a primitive
+ * restart triangle fan. The corners take texture coordinates (0, 0),
+ * (w, 0), (w, h) and (0, h). The layer must fit its eight bits; it is masked
+ * so that a larger one cannot spill into the slot.
+ */
+inline void TerrainMesh::appendQuad(
+	const glm::ivec3 corners[4],
+	int normal,
+	int w, int h,
+	int layer,
+	std::vector<TerrainVertex>* v,
+	std::vector<GLuint>* i
+)
+{
+	assert( layer >= 0 && layer < 256 );
+
+	const int s[4] = { 0, w, w, 0 };
+	const int t[4] = { 0, 0, h, h };
+
+#ifndef TRN_QUAD_INDICES
+	GLuint offset = (GLuint) v->size();
+	GLuint i_a[5] = { offset, offset + 1, offset + 2, offset + 3, 0xffffffff };
+	i->insert( i->end(), i_a, i_a + 5 );
+#else
+	(void) i; // Quads share one index buffer; see TerrainArena.
+#endif
+
+	for ( int n = 0; n < 4; n++ )
+	{
+		TerrainVertex tv = {
+			(GLuint) ( corners[n].x | corners[n].y << 6 | corners[n].z << 12 | normal << 18 ),
+			(GLuint) ( s[n] | t[n] << 6 | ( layer & 255 ) << 12 )
+		};
+		v->push_back( tv );
+	}
+}
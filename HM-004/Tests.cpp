@@ -0,0 +1,406 @@
+#include "Base.h"
+#include "Tests.h"
+
+#include "GenPipeline.h"
+#include "GenStages.h"
+#include "Noise.h"
+#include "OcclusionCuller.h"
+#include "Terrain.h"
+#include "ThreadPool.h"
+
+#include <cfloat>
+
+
+/*!
+ * World hashes (Terrain::getHash) of the default island for a few seeds. Seed
+ * 0 is the island as generated before the threaded, SIMD and fused
+ * generators it guards. Every generator must reproduce these exactly. Only
+ * valid while TRN_CAVE_STRIDE is 1.
+ */
+static const struct {
+	unsigned int seed;
+	unsigned long long hash;
+} golden[] = {
+	{ 0,     0x956F159FAE089803ULL },
+	{ 1,     0xF82C0D551679B6F5ULL },
+	{ 12345, 0xFD5D404E6E4D0D85ULL },
+};
+
+
+/*!
+ * Rounds a division towards negative infinity.
+ */
+static int floorDiv( int a, int b )
+{
+	return a >= 0 ? a / b : -( ( -a + b - 1 ) / b );
+}
+
+
+/*!
+ * Runs every test, returning true if all passed.
+ */
+bool Tests::run( void )
+{
+	bool passed = noisePaths();
+	passed &= goldenHashes();
+
+	// Strides that divide the chunk size and strides that do not, which
+	// leave the lattice at a different phase in every chunk.
+	int strides[] = { 2, 4, 5, 6, 7, 9 };
+	for ( int stride : strides )
+		passed &= caveLattice( stride );
+
+	passed &= occlusionEdges();
+
+	std::cout << ( passed ? "All tests passed.\n" : "TESTS FAILED.\n" );
+
+	return passed;
+}
+
+
+/*!
+ * Samples a grid in 2D and 3D through every noise path the CPU supports, in
+ * rows whose lengths leave a partial vector, and through the single point
+ * functions, and checks every result against glm::simplex. The grid spans
+ * negative coordinates and the seed offsets, which reach 289.
+ */
+bool Tests::noisePaths( void )
+{
+	const float tolerance = 1e-5f;
+	const int   row  = 37;
+	const int   rows = 8 * row;
+	const int   n    = rows * row;
+
+	std::vector<float> x( n ), y( n ), z( n ), out( n );
+	for ( int r = 0; r < rows; r++ )
+	for ( int i = 0; i < row; i++ )
+	{
+		x[r * row + i] = -16.0f + r * 1.13f;
+		y[r * row + i] = -16.0f + ( r * 7 % rows ) * 1.13f;
+		z[r * row + i] = -16.0f + i * 9.07f + r * 0.031f;
+	}
+
+	std::vector<float> expected2( n ), expected3( n );
+	for ( int i = 0; i < n; i++ )
+	{
+		expected2[i] = glm::simplex( glm::vec2( x[i], z[i] ) );
+		expected3[i] = glm::simplex( glm::vec3( x[i], y[i], z[i] ) );
+	}
+
+	float worst = 0.0f;
+	int wrong = 0, total = 0;
+
+	auto compare = [&]( const char* name, int dims, const float* expected )
+	{
+		int bad = 0;
+		for ( int i = 0; i < n; i++ )
+		{
+			float error = std::abs( out[i] - expected[i] );
+			worst = std::max( worst, error );
+			bad += !( error <= tolerance );
+		}
+
+		if ( bad )
+			std::cout << "  " << name << " " << dims << "D: " << bad << " of " << n << " points off\n";
+
+		wrong += bad;
+		total += n;
+	};
+
+	NoisePath original = Noise::getPath();
+
+	for ( int p = NOISE_SCALAR; p <= NOISE_AVX2; p++ )
+	{
+		if ( !Noise::setPath( (NoisePath) p ) )
+			continue;
+
+		for ( int r = 0; r < rows; r++ )
+			Noise::simplex( &x[r * row], &z[r * row], &out[r * row], row );
+		compare( Noise::getPathName( (NoisePath) p ), 2, &expected2[0] );
+
+		for ( int r = 0; r < rows; r++ )
+			Noise::simplex( &x[r * row], &y[r * row], &z[r * row], &out[r * row], row );
+		compare( Noise::getPathName( (NoisePath) p ), 3, &expected3[0] );
+	}
+
+	Noise::setPath( original );
+
+	for ( int i = 0; i < n; i++ )
+		out[i] = Noise::simplex( glm::vec2( x[i], z[i] ) );
+	compare( "single point", 2, &expected2[0] );
+
+	for ( int i = 0; i < n; i++ )
+		out[i] = Noise::simplex( glm::vec3( x[i], y[i], z[i] ) );
+	compare( "single point", 3, &expected3[0] );
+
+	std::cout << "Noise paths: " << wrong << " of " << total << " points off glm::simplex, worst "
+	          << worst << ( wrong ? ", FAILED\n" : "\n" );
+
+	return wrong == 0;
+}
+
+
+/*!
+ * Generates the island for each golden seed on every noise path the CPU
+ * supports, and seed 0 on one thread as well as on all of them, and checks
+ * every world hash.
+ */
+bool Tests::goldenHashes( void )
+{
+	const int goldens = sizeof ( golden ) / sizeof ( golden[0] );
+	int wrong = 0, total = 0;
+
+	auto check = [&]( int g, int threads )
+	{
+		Terrain* terrain = new Terrain( WorldGenParams( golden[g].seed ), threads );
+		unsigned long long hash = terrain->getHash();
+		delete terrain;
+
+		if ( hash != golden[g].hash )
+		{
+			std::cout << "  seed " << golden[g].seed << ", " << Noise::getPathName( Noise::getPath() ) << ", "
+			          << threads << " threads: " << std::hex << hash << std::dec << "\n";
+			wrong++;
+		}
+		total++;
+	};
+
+	NoisePath original = Noise::getPath();
+
+	for ( int p = NOISE_SCALAR; p <= NOISE_AVX2; p++ )
+	{
+		if ( !Noise::setPath( (NoisePath) p ) )
+			continue;
+
+		for ( int g = 0; g < goldens; g++ )
+			check( g, ThreadPool::getHardwareThreads() );
+	}
+
+	Noise::setPath( original );
+	check( 0, 1 );
+
+	std::cout << "Golden hashes: " << wrong << " of " << total << " worlds wrong"
+	          << ( wrong ? ", FAILED\n" : "\n" );
+
+	return wrong == 0;
+}
+
+
+/*!
+ * Carves solid chunks at positive and negative coordinates with a cave
+ * lattice of the given stride, and compares every block with one carved from
+ * the eight lattice points around it, sampled directly, which is what the
+ * lattice approximates wherever the chunk lies. Blocks within rounding of
+ * the threshold may go either way.
+ */
+bool Tests::caveLattice( int stride )
+{
+	const int size = TRN_CHUNK_SIZE;
+
+	WorldGenParams params;
+	params.caveStride = stride;
+	CaveStage stage( params );
+	glm::vec3 offset = params.getOffset( 2 );
+
+	std::vector<Block> blocks( size );
+	std::vector<float> scratch( size * 4 );
+	std::vector<float> data( stage.getChunkDataSize( size ) );
+
+	glm::ivec3 chunks[] = {
+		glm::ivec3(  0, 0,  0 ), glm::ivec3(  1, 1,  2 ), glm::ivec3(  3, 0, 5 ),
+		glm::ivec3( -1, 2, -3 ), glm::ivec3( -4, 1,  1 ), glm::ivec3(  2, 3, -1 )
+	};
+
+	int wrong = 0, total = 0;
+	for ( glm::ivec3 chunk : chunks )
+	{
+		std::fill( data.begin(), data.end(), 0.0f );
+
+		GenRow row;
+		row.size    = size;
+		row.column  = 0;
+		row.scratch = &scratch[0];
+		row.data    = &data[0];
+
+		for ( row.x = 0; row.x < size; row.x++ )
+		for ( row.y = 0; row.y < size; row.y++ )
+		{
+			row.world = chunk * size + glm::ivec3( row.x, row.y, 0 );
+
+			Block solid = { 1 };
+			std::fill( blocks.begin(), blocks.end(), solid );
+			stage.voxels( row, &blocks[0] );
+
+			for ( int z = 0; z < size; z++ )
+			{
+				glm::ivec3 p = row.world + glm::ivec3( 0, 0, z );
+				glm::ivec3 g( floorDiv( p.x, stride ), floorDiv( p.y, stride ), floorDiv( p.z, stride ) );
+				glm::vec3  f = glm::vec3( p - g * stride ) / (float) stride;
+
+				// The corners, in the same order of operations as CaveStage.
+				float corner[2][2][2];
+				for ( int i = 0; i < 8; i++ )
+				{
+					glm::ivec3 c = g + glm::ivec3( i >> 2 & 1, i >> 1 & 1, i & 1 );
+					float x = (float) ( c.x * stride / (double) params.caveScale ) + offset.x;
+					float y = (float) ( c.y * stride / (double) params.caveScale ) + offset.y;
+					float z = (float) ( c.z * stride / (double) params.caveScale ) + offset.z;
+					Noise::simplex( &x, &y, &z, &corner[i >> 2 & 1][i >> 1 & 1][i & 1], 1 );
+				}
+
+				float line[2];
+				for ( int k = 0; k < 2; k++ )
+				{
+					float a = corner[0][0][k] + ( corner[0][1][k] - corner[0][0][k] ) * f.y;
+					float b = corner[1][0][k] + ( corner[1][1][k] - corner[1][0][k] ) * f.y;
+					line[k] = a + ( b - a ) * f.x;
+				}
+				float noise = line[0] + ( line[1] - line[0] ) * f.z;
+
+				double value = noise - p.y / (double) params.caveFalloff;
+				if ( ( value > 0 ) != ( blocks[z].id == 0 ) && std::abs( value ) > 1e-4 )
+					wrong++;
+				total++;
+			}
+		}
+	}
+
+	std::cout << "Cave lattice, stride " << stride << ": " << wrong << " of " << total << " blocks wrong"
+	          << ( wrong ? ", FAILED\n" : "\n" );
+
+	return wrong == 0;
+}
+
+
+/*!
+ * Returns the point at the given pixel of an occlusion buffer of the given
+ * size, at distance w straight ahead, seen through occlusionView().
+ */
+static glm::vec3 occlusionPoint( const OcclusionCuller& culler, glm::vec2 pixel, float w )
+{
+	return glm::vec3(
+		( pixel.x / ( culler.getWidth()  * 0.5f ) - 1.0f ) * w,
+		( pixel.y / ( culler.getHeight() * 0.5f ) - 1.0f ) * w,
+		-w
+	);
+}
+
+
+/*!
+ * Returns whether the culler finds visible a thin box at distance w whose
+ * face covers the given rectangle of pixels, or more.
+ */
+static bool occlusionVisible( const OcclusionCuller& culler, glm::vec2 lo, glm::vec2 hi, float w )
+{
+	glm::vec3 min( FLT_MAX ), max( -FLT_MAX );
+	for ( int i = 0; i < 8; i++ )
+	{
+		glm::vec2 pixel( ( i & 1 ) ? hi.x : lo.x, ( i & 2 ) ? hi.y : lo.y );
+		glm::vec3 p = occlusionPoint( culler, pixel, ( i & 4 ) ? w + 0.01f : w );
+		min = glm::min( min, p );
+		max = glm::max( max, p );
+	}
+
+	return culler.test( min, max );
+}
+
+
+/*!
+ * Draws occluders a pixel or less from the edges of boxes behind them, at
+ * every sixteenth of a pixel, in a view where the occlusion buffer lines up
+ * with the screen, and checks that none hides a box any of which shows:
+ *
+ *   silhouettes: an occluder edge, straight or at an angle, stopping just
+ *                short of the edge of a box;
+ *   gaps:        two occluders side by side, leaving a gap narrower than a
+ *                pixel in front of a box.
+ *
+ * Boxes wholly behind, which must be hidden, and in front of or flush with
+ * an occluder, which must not, check the culler is doing anything at all.
+ */
+bool Tests::occlusionEdges( void )
+{
+	OcclusionCuller culler;
+
+	// Clip x and y are eye x and y, and w is the distance ahead.
+	glm::mat4 view( 0.0f );
+	view[0][0] = 1.0f;
+	view[1][1] = 1.0f;
+	view[2][2] = -1.0f;
+	view[2][3] = -1.0f;
+
+	// Distances of the occluders and of the boxes behind them.
+	const float front = 10.0f, back = 20.0f;
+	int wrong = 0, total = 0;
+
+	// Adds an occluder covering a quad of pixels, given in order around it.
+	auto occluder = [&]( glm::vec2 a, glm::vec2 b, glm::vec2 c, glm::vec2 d ) {
+		glm::vec3 corners[4] = {
+			occlusionPoint( culler, a, front ), occlusionPoint( culler, b, front ),
+			occlusionPoint( culler, c, front ), occlusionPoint( culler, d, front )
+		};
+		culler.addOccluder( corners );
+	};
+	auto rect = [&]( glm::vec2 lo, glm::vec2 hi ) {
+		occluder( lo, glm::vec2( hi.x, lo.y ), hi, glm::vec2( lo.x, hi.y ) );
+	};
+	auto expect = [&]( bool visible, glm::vec2 lo, glm::vec2 hi, float w ) {
+		if ( occlusionVisible( culler, lo, hi, w ) != visible )
+			wrong++;
+		total++;
+	};
+
+	for ( int step = 0; step < 16; step++ )
+	{
+		float f = step / 16.0f;
+
+		// Silhouettes of a straight edge, on each side of an occluder, the
+		// box showing a tenth of a pixel past it.
+		culler.begin( view );
+		rect( glm::vec2( 20.0f, 20.0f ), glm::vec2( 100.0f + f, 100.0f + f ) );
+		culler.render();
+		expect( true, glm::vec2( 60.0f, 40.0f ), glm::vec2( 100.1f + f, 60.0f ), back );
+		expect( true, glm::vec2( 40.0f, 60.0f ), glm::vec2( 60.0f, 100.1f + f ), back );
+		expect( true, glm::vec2( 19.9f, 40.0f ), glm::vec2( 60.0f, 60.0f ), back );
+		expect( true, glm::vec2( 40.0f, 19.9f ), glm::vec2( 60.0f, 60.0f ), back );
+		expect( false, glm::vec2( 40.0f, 40.0f ), glm::vec2( 60.0f, 60.0f ), back );
+		expect( true, glm::vec2( 40.0f, 40.0f ), glm::vec2( 60.0f, 60.0f ), front * 0.5f );
+		expect( true, glm::vec2( 20.0f, 20.0f ), glm::vec2( 100.0f + f, 100.0f + f ), front );
+
+		// Silhouettes of a sloping edge, at angles around the circle, the
+		// box's corner showing a tenth of a pixel past it.
+		for ( int angle = 0; angle < 360; angle += 15 )
+		{
+			float radians = glm::radians( angle + f * 15.0f );
+			glm::vec2 n( cosf( radians ), sinf( radians ) );
+			glm::vec2 t( -n.y, n.x );
+			glm::vec2 centre( 60.0f, 60.0f );
+
+			culler.begin( view );
+			occluder( centre + t * 40.0f, centre - t * 40.0f, centre - t * 40.0f - n * 40.0f, centre + t * 40.0f - n * 40.0f );
+			culler.render();
+
+			glm::vec2 corner = centre + n * 0.1f;
+			glm::vec2 inner  = corner - glm::vec2( n.x > 0.0f ? 10.0f : -10.0f, n.y > 0.0f ? 10.0f : -10.0f );
+			expect( true, glm::min( corner, inner ), glm::max( corner, inner ), back );
+		}
+
+		// Gaps a tenth of a pixel wide, across and down.
+		culler.begin( view );
+		rect( glm::vec2( 20.0f, 20.0f ), glm::vec2( 60.0f + f, 100.0f ) );
+		rect( glm::vec2( 60.1f + f, 20.0f ), glm::vec2( 100.0f, 100.0f ) );
+		culler.render();
+		expect( true, glm::vec2( 40.0f, 40.0f ), glm::vec2( 80.0f, 60.0f ), back );
+
+		culler.begin( view );
+		rect( glm::vec2( 20.0f, 20.0f ), glm::vec2( 100.0f, 60.0f + f ) );
+		rect( glm::vec2( 20.0f, 60.1f + f ), glm::vec2( 100.0f, 100.0f ) );
+		culler.render();
+		expect( true, glm::vec2( 40.0f, 40.0f ), glm::vec2( 60.0f, 80.0f ), back );
+	}
+
+	std::cout << "Occlusion edges: " << wrong << " of " << total << " boxes wrong"
+	          << ( wrong ? ", FAILED\n" : "\n" );
+
+	return wrong == 0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+
+/*!
+ * Checks of results that the game cannot see go wrong by looking, each
+ * printing a line and passing or failing. Needs no window; runs in place of
+ * the game when built with TEST_MODE, as the hm004-tests target of
+ * CMakeLists.txt does, which CTest runs.
+ */
+class Tests {
+private:
+	static bool goldenHashes( void );
+	static bool noisePaths( void );
+	static bool caveLattice( int stride );
+	static bool occlusionEdges( void );
+
+public:
+	static bool run( void );
+};
@@ -2,6 +2,7 @@
 #include "Texture.h"
 
 #include "File.h"
+#include "GLState.h"
 
 #include "stb_image.h"
 
@@ -121,10 +122,7 @@ unsigned char* Texture::flipY( unsigned char* data, int width, int height, int d
  */
 void Texture::bind( void )
 {
-	unbind();
-
-	glActiveTexture( GL_TEXTURE0 );
-	glBindTexture( type, ID );
+	GLState::bindTexture( 0, type, ID );
 }
 
 
@@ -133,9 +131,17 @@ void Texture::bind( void )
  */
 void Texture::unbind( void )
 {
-	glActiveTexture( GL_TEXTURE0 );
-	glBindTexture( GL_TEXTURE_2D, 0 );
-	glBindTexture( GL_TEXTURE_2D_ARRAY, 0 );
+	GLState::bindTexture( 0, GL_TEXTURE_2D, 0 );
+	GLState::bindTexture( 0, GL_TEXTURE_2D_ARRAY, 0 );
+}
+
+
+/*!
+ * Returns the GL name of the texture.
+ */
+GLuint Texture::getID( void ) const
+{
+	return ID;
 }
 
 
@@ -149,7 +155,7 @@ Texture* ResourceLoader<Texture>::load( std::string url )
 
 	if ( !result )
 	{
-		throw std::exception( (
+		throw std::runtime_error( (
 			"Failed to parse texture xml file at \"" + url + "\".\n" +
 			result.description() + "."
 		).c_str() );
@@ -176,7 +182,7 @@ Texture* ResourceLoader<Texture>::load( std::string url )
 		return new Texture_2D_Array( name, img_urls );
 	} else
 	{
-		throw std::exception( (
+		throw std::runtime_error( (
 			"Invalid texture type in file \"" + url + "\"."
 		).c_str() );
 	}
@@ -28,6 +28,8 @@ public:
 
 	       void   bind( void );
 	static void unbind( void );
+
+	GLuint getID( void ) const;
 };
 
 class Texture_2D : public Texture {
@@ -0,0 +1,124 @@
+#include "Base.h"
+#include "ThreadPool.h"
+
+
+/*!
+ * Starts the given number of worker threads, or one per hardware thread if
+ * zero.
+ */
+ThreadPool::ThreadPool( int threads ) :
+	running( 0 ),
+	stopping( false )
+{
+	if ( threads <= 0 )
+		threads = getHardwareThreads();
+
+	for ( int i = 0; i < threads; i++ )
+		workers.push_back( std::thread( &ThreadPool::work, this ) );
+}
+
+
+/*!
+ * Finishes any queued jobs, then joins every worker.
+ */
+ThreadPool::~ThreadPool( void )
+{
+	{
+		std::unique_lock<std::mutex> lock( mutex );
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for ( auto& w : workers )
+		w.join();
+}
+
+
+/*!
+ * Worker loop. Takes jobs until the pool is stopping and the queue is empty.
+ */
+void ThreadPool::work( void )
+{
+	for ( ;; )
+	{
+		std::function<void( void )> job;
+		{
+			std::unique_lock<std::mutex> lock( mutex );
+			wake.wait( lock, [this] { return stopping || !jobs.empty(); } );
+
+			if ( jobs.empty() )
+				return;
+
+			job = std::move( jobs.front() );
+			jobs.pop_front();
+			running++;
+		}
+
+		job();
+
+		{
+			std::unique_lock<std::mutex> lock( mutex );
+			running--;
+			if ( !running && jobs.empty() )
+				idle.notify_all();
+		}
+	}
+}
+
+
+/*!
+ * Queues a job to run on the next free worker.
+ */
+void ThreadPool::submit( std::function<void( void )> job )
+{
+	{
+		std::unique_lock<std::mutex> lock( mutex );
+		jobs.push_back( std::move( job ) );
+	}
+	wake.notify_one();
+}
+
+
+/*!
+ * Blocks until every submitted job has finished.
+ */
+void ThreadPool::wait( void )
+{
+	std::unique_lock<std::mutex> lock( mutex );
+	idle.wait( lock, [this] { return !running && jobs.empty(); } );
+}
+
+
+/*!
+ * Blocks until every submitted job has finished or the timeout passes.
+ * Returns true if the jobs finished.
+ */
+bool ThreadPool::wait( int milliseconds )
+{
+	std::unique_lock<std::mutex> lock( mutex );
+	return idle.wait_for(
+		lock,
+		std::chrono::milliseconds( milliseconds ),
+		[this] { return !running && jobs.empty(); }
+	);
+}
+
+
+/*!
+ * Returns the number of worker threads.
+ */
+int ThreadPool::getThreadCount( void ) const
+{
+	return (int) workers.size();
+}
+
+
+/*!
+ * Returns the number of hardware threads, or one if it cannot be found.
+ */
+int ThreadPool::getHardwareThreads( void )
+{
+	int n = (int) std::thread::hardware_concurrency();
+
+	return n > 0 ? n : 1;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+
+/*!
+ * A fixed set of worker threads taking jobs from a shared FIFO queue. Jobs
+ * must not touch GL or the window; the thread that submits them stays free
+ * to keep the window responsive while they run.
+ */
+class ThreadPool {
+private:
+	std::vector<std::thread> workers;
+	std::deque<std::function<void( void )>> jobs;
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable idle;
+
+	int  running;
+	bool stopping;
+
+	void work( void );
+
+public:
+	ThreadPool( int threads = 0 );
+	~ThreadPool( void );
+
+	void submit( std::function<void( void )> job );
+
+	void wait( void );
+	bool wait( int milliseconds );
+
+	int getThreadCount( void ) const;
+
+	static int getHardwareThreads( void );
+};
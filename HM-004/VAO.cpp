@@ -1,6 +1,8 @@
 #include "Base.h"
 #include "VAO.h"
 
+#include "GLState.h"
+
 
 /*!
  * Generate a vertex array object.
@@ -11,12 +13,18 @@ VAO::VAO( void )
 }
 
 
+VAO::~VAO( void )
+{
+	GLState::deleteVertexArray( ID );
+}
+
+
 /*!
  * Bind the vertex array object asscociated with this object.
  */
 void VAO::bind( void )
 {
-	glBindVertexArray( ID );
+	GLState::bindVertexArray( ID );
 }
 
 
@@ -25,5 +33,5 @@ void VAO::bind( void )
  */
 void VAO::unbind( void )
 {
-	glBindVertexArray( 0 );
+	GLState::bindVertexArray( 0 );
 }
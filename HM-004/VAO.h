@@ -6,7 +6,8 @@ private:
 	GLuint ID;
 
 public:
-	VAO( void );
+	 VAO( void );
+	~VAO( void );
 
 	       void   bind( void );
 	static void unbind( void );
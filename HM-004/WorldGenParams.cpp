@@ -0,0 +1,48 @@
+#include "Base.h"
+#include "WorldGenParams.h"
+
+
+/*!
+ * Creates the default island for the given seed.
+ */
+WorldGenParams::WorldGenParams( unsigned int seed ) :
+	seed( seed ),
+	width( 18 ),
+	height( 8 ),
+	depth( 18 ),
+	islandHeight( 48.0f ),
+	islandRadius( 144.0f ),
+	islandFalloff( 80.0f ),
+	hillScale( 100.0f ),
+	hillHeight( 16.0f ),
+	caveScale( 30.0f ),
+	caveFalloff( 96.0f ),
+	sealScale( 90.0f ),
+	caveStride( TRN_CAVE_STRIDE )
+{
+}
+
+
+/*!
+ * Returns the offset, in noise space, that a stage adds to its noise
+ * coordinates. Each stage passes its own number so no two stages line up.
+ * Offsets stay within one period of the noise's permutation, to keep float
+ * precision.
+ */
+glm::vec3 WorldGenParams::getOffset( int stage ) const
+{
+	if ( seed == 0 )
+		return glm::vec3( 0.0f );
+
+	// SplitMix64 finaliser over the seed and stage.
+	unsigned long long h = ( (unsigned long long) seed << 32 | (unsigned int) stage ) + 0x9E3779B97F4A7C15ULL;
+	h = ( h ^ ( h >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+	h = ( h ^ ( h >> 27 ) ) * 0x94D049BB133111EBULL;
+	h =   h ^ ( h >> 31 );
+
+	return glm::vec3(
+		(float) (   h         & 0xFFFF ) / 65536.0f * 289.0f,
+		(float) ( ( h >> 16 ) & 0xFFFF ) / 65536.0f * 289.0f,
+		(float) ( ( h >> 32 ) & 0xFFFF ) / 65536.0f * 289.0f
+	);
+}
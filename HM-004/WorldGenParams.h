@@ -0,0 +1,39 @@
+#pragma once
+
+
+#include "MacroTerrain.h"
+
+
+/*!
+ * Everything that decides what the island looks like. Two terrains generated
+ * from equal params hold identical blocks, whatever the number of threads or
+ * noise path; Chunk::getHash() and Terrain::getHash() check this.
+ *
+ * Each stage moves its noise by an offset picked from the seed, so seeds
+ * give different islands of the same shape. Seed 0 uses no offset at all.
+ */
+struct WorldGenParams {
+	unsigned int seed;
+
+	// World extents, in chunks.
+	int width, height, depth;
+
+	// The island's slope: its height at the centre, the distance from the
+	// corner to the centre, and how steeply it falls away from there.
+	float islandHeight;
+	float islandRadius;
+	float islandFalloff;
+
+	// Blocks across the noise features of each stage, and the hills' height.
+	float hillScale;
+	float hillHeight;
+	float caveScale;
+	float caveFalloff; // Blocks of height over which caves close up.
+	float sealScale;
+
+	int caveStride; // See CaveStage.
+
+	WorldGenParams( unsigned int seed = 0 );
+
+	glm::vec3 getOffset( int stage ) const;
+};
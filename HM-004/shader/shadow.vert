@@ -1,13 +1,24 @@
 #version 400
 
-layout(location = 0) in vec3 i_pos;
-layout(location = 1) in vec3 i_tex;
-layout(location = 2) in vec3 i_normal;
+// Packed vertex, see TerrainVertex and terrain.vert. Only the position and
+// slot are needed for depth.
+layout(location = 0) in uvec2 i_packed;
 
 uniform mat4 u_MV;
 uniform mat4 u_P;
 
+// Absolute positions of chunk origins, by TerrainArena slot.
+uniform isamplerBuffer u_iBuffer; // Unit 2.
+
 void main( void )
 {
-	gl_Position = u_P * u_MV * vec4( i_pos, 1.0 );
+	vec3 pos = vec3(
+		i_packed.x         & 63u,
+		( i_packed.x >> 6  ) & 63u,
+		( i_packed.x >> 12 ) & 63u
+	);
+	uint slot   = ( i_packed.y >> 20 ) | ( ( i_packed.x >> 21 ) & 15u ) << 12;
+	vec3 offset = vec3( texelFetch( u_iBuffer, int( slot ) ).xyz );
+
+	gl_Position = u_P * u_MV * vec4( pos + offset, 1.0 );
 }
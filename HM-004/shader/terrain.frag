@@ -6,8 +6,14 @@ in vec3  f_tex;
 in vec3  f_normal;
 in float f_fog;
 
-uniform vec3 u_lightDir;
-uniform vec3 u_lightColor;
+// Per-frame constants, see FrameData.
+layout(std140) uniform Frame {
+	mat4 u_view;
+	mat4 u_projection;
+	mat3 u_normal;
+	vec4 u_lightDir;
+	vec4 u_lightColor;
+};
 
 uniform sampler2DArray u_2DArray; // Unit 0.
 
@@ -17,13 +23,13 @@ void main( void )
 	float ambient = 0.6;
 
 	// Diffuse part:
-	float diffuse = max( dot( f_normal, u_lightDir ), 0.0 );
+	float diffuse = max( dot( f_normal, u_lightDir.xyz ), 0.0 );
 
 	o_color = vec4(
 		mix(
 			vec3( 0.529, 0.808, 0.922 ),
 			( ambient + diffuse ) *
-			u_lightColor *
+			u_lightColor.rgb *
 			texture( u_2DArray, f_tex ).rgb,
 			f_fog
 		),
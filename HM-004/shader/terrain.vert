@@ -5,26 +5,57 @@
 #define RECP_128 0.0078125
 #define RECP_64  0.015625
 
-layout(location = 0) in vec3 i_pos;
-layout(location = 1) in vec3 i_tex;
-layout(location = 2) in vec3 i_normal;
+// Packed vertex, see TerrainVertex:
+//   x: x | y << 6 | z << 12 | normal << 18 | ( slot >> 12 ) << 21
+//   y: s | t << 6 | layer << 12 | ( slot & 4095 ) << 20
+layout(location = 0) in uvec2 i_packed;
 
 out vec3  f_pos;
 out vec3  f_tex;
 out vec3  f_normal;
 out float f_fog;
 
-uniform mat4 u_MV;
-uniform mat4 u_P;
-uniform mat3 u_N;
+// Per-frame constants, see FrameData.
+layout(std140) uniform Frame {
+	mat4 u_view;
+	mat4 u_projection;
+	mat3 u_normal;
+	vec4 u_lightDir;
+	vec4 u_lightColor;
+};
+
+// Absolute positions of chunk origins, by TerrainArena slot.
+uniform isamplerBuffer u_iBuffer; // Unit 2.
+
+const vec3 normals[6] = vec3[6](
+	vec3(  1.0,  0.0,  0.0 ),
+	vec3( -1.0,  0.0,  0.0 ),
+	vec3(  0.0,  1.0,  0.0 ),
+	vec3(  0.0, -1.0,  0.0 ),
+	vec3(  0.0,  0.0,  1.0 ),
+	vec3(  0.0,  0.0, -1.0 )
+);
 
 void main( void )
 {
-	gl_Position = u_MV * vec4( i_pos, 1.0 );
+	vec3 pos = vec3(
+		i_packed.x         & 63u,
+		( i_packed.x >> 6  ) & 63u,
+		( i_packed.x >> 12 ) & 63u
+	);
+	vec3 normal = normals[( i_packed.x >> 18 ) & 7u];
+	uint slot   = ( i_packed.y >> 20 ) | ( ( i_packed.x >> 21 ) & 15u ) << 12;
+	vec3 offset = vec3( texelFetch( u_iBuffer, int( slot ) ).xyz );
+
+	gl_Position = u_view * vec4( pos + offset, 1.0 );
 
-	f_tex = i_tex;
-	f_normal = normalize( u_N * i_normal );
+	f_tex = vec3(
+		i_packed.y         & 63u,
+		( i_packed.y >> 6  ) & 63u,
+		( i_packed.y >> 12 ) & 255u
+	);
+	f_normal = normalize( u_normal * normal );
 	f_fog = 1.0 - max( 0, -( 64 + gl_Position.z ) * RECP_64 );
 
-	gl_Position = u_P * gl_Position;
+	gl_Position = u_projection * gl_Position;
 }